@@ -0,0 +1,49 @@
+// Headless benchmark for the zombie crowd separation (no window or GL context needed)
+// prints the update time for increasing agent counts, the budget is 1 ms at 2000 agents
+// usage: crowd-bench [ticks]
+#include "enemy_system/crowd.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    int nTicks = argc > 1 ? std::stoi(argv[1]) : 300;
+    float arenaSize = 38.0f;
+    float delta = 1.0f / 60.0f;
+
+    std::cout << "agents\tavg ms\tmax ms" << std::endl;
+    for (int nAgents : {250, 500, 1000, 2000, 4000, 8000})
+    {
+        std::mt19937 gen(1337); // fixed seed for comparable runs
+        std::uniform_real_distribution<float> disPos(-arenaSize, arenaSize);
+
+        Crowd crowd({-arenaSize, 0, -arenaSize}, {arenaSize, 0, arenaSize}, 1.0f);
+        crowd.resize(nAgents);
+        for (int i = 0; i < nAgents; i++)
+        {
+            crowd.posX[i] = disPos(gen);
+            crowd.posZ[i] = disPos(gen);
+        }
+
+        float total = 0.0f, worst = 0.0f;
+        for (int tick = 0; tick < nTicks; tick++)
+        {
+            crowd.update();
+            total += crowd.lastUpdateMs;
+            worst = std::max(worst, crowd.lastUpdateMs);
+
+            // seek towards the center plus separation, so the crowd gets denser over time
+            for (int i = 0; i < nAgents; i++)
+            {
+                glm::vec3 seek = glm::normalize(glm::vec3(-crowd.posX[i], 0.0f, -crowd.posZ[i]) + glm::vec3(0.001f));
+                crowd.posX[i] += (seek.x * 2.5f + crowd.forceX[i] * 4.0f) * delta;
+                crowd.posZ[i] += (seek.z * 2.5f + crowd.forceZ[i] * 4.0f) * delta;
+            }
+        }
+        std::cout << nAgents << '\t' << total / nTicks << '\t' << worst << std::endl;
+    }
+    return 0;
+}
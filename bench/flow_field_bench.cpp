@@ -0,0 +1,59 @@
+// Headless benchmark for the zombie flow field (no window or GL context needed)
+// usage: flow-field-bench [agents] [arenaSize] [ticks]
+#include "enemy_system/flow_field.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    int nAgents = argc > 1 ? std::stoi(argv[1]) : 5000;
+    float arenaSize = argc > 2 ? std::stof(argv[2]) : 40.0f;
+    int nTicks = argc > 3 ? std::stoi(argv[3]) : 600;
+    float delta = 1.0f / 60.0f;
+
+    std::mt19937 gen(1337); // fixed seed for comparable runs
+    std::uniform_real_distribution<float> disPos(-arenaSize, arenaSize);
+
+    // arena with some scattered pillars as obstacles
+    FlowField flowField({-arenaSize, 0, -arenaSize}, {arenaSize, 0, arenaSize}, 1.0f);
+    for (int i = 0; i < (int)(arenaSize * arenaSize / 50.0f); i++)
+    {
+        glm::vec3 center(disPos(gen), 0, disPos(gen));
+        flowField.add_obstacle(center - glm::vec3(1.0f), center + glm::vec3(1.0f));
+    }
+
+    std::vector<glm::vec3> agents(nAgents);
+    for (auto &agent : agents)
+        agent = glm::vec3(disPos(gen), 0, disPos(gen));
+
+    using clock = std::chrono::steady_clock;
+    double rebuildTime = 0.0, steerTime = 0.0;
+    int nRebuilds = 0;
+    for (int tick = 0; tick < nTicks; tick++)
+    {
+        // player walks in a circle, so the target changes cells regularly
+        float angle = tick * delta * 0.5f;
+        glm::vec3 player(std::cos(angle) * arenaSize * 0.5f, 2.0f, std::sin(angle) * arenaSize * 0.5f);
+
+        auto start = clock::now();
+        if (flowField.update(player))
+            nRebuilds++;
+        auto mid = clock::now();
+        for (auto &agent : agents)
+            agent += flowField.direction(agent) * (2.5f * delta);
+        auto end = clock::now();
+
+        rebuildTime += std::chrono::duration<double, std::milli>(mid - start).count();
+        steerTime += std::chrono::duration<double, std::milli>(end - mid).count();
+    }
+
+    std::cout << "grid:            " << flowField.get_size_x() << " x " << flowField.get_size_z() << " cells" << std::endl;
+    std::cout << "agents:          " << nAgents << std::endl;
+    std::cout << "ticks:           " << nTicks << std::endl;
+    std::cout << "rebuilds:        " << nRebuilds << " (" << (nRebuilds ? rebuildTime / nRebuilds : 0.0) << " ms avg)" << std::endl;
+    std::cout << "steering/tick:   " << steerTime / nTicks << " ms (" << steerTime / nTicks / nAgents * 1000000.0 << " ns per agent)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+// Counts the heap allocations (operator new) of the calling thread, to spot per-frame allocations.
+// Only available in debug builds, the counter stays 0 in release builds.
+namespace AllocationCounter {
+#ifndef NDEBUG
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    uint64_t get() noexcept;
+}
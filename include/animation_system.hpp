@@ -0,0 +1,180 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cfloat>
+#include <unordered_map>
+#include <chrono>
+#include <bit>
+#include <glm/glm.hpp>
+//
+#include "stream_buffer.hpp"
+#include "job_pool.hpp"
+#include "render_snapshot.hpp"
+#include "game_objects/model.hpp"
+#include "game_objects/animation.hpp"
+
+// Skinning palettes for all instances of a skinned model, streamed to the GPU once per frame and shared by all passes.
+// LOD by distance: near instances blend idle/walk at their exact time, farther ones play only the dominant clip
+// at a coarser time step, so instances with the same clip and step share one palette that is evaluated once.
+// The unique palettes are evaluated in parallel on the job pool.
+// Instances beyond bakedDistance play the model's vertex animation texture instead and need no palette at all.
+// Beyond impostorDistance instances become impostors: within the fade range they are drawn both ways (cross-fade),
+// farther away they are left out of the instance buffer and only listed in impostors.
+struct AnimationSystem {
+    struct Lod {
+        float distance; // up to
+        float timeStep; // 0 = exact time
+        bool bBlend;
+    };
+    static constexpr std::array<Lod, 3> lods = {{
+        {15.0f, 0.0f, true},
+        {40.0f, 1.0f / 30.0f, false},
+        {FLT_MAX, 1.0f / 8.0f, false},
+    }};
+
+    // time is the simulation time of the snapshot, the baked instances store their offset to it
+    void update(const Model& model, const std::vector<Transform>& transforms, const std::vector<RenderSnapshot::EnemyAnimation>& animations,
+                float time, glm::vec3 viewPosition, StreamBuffer& streamBuffer, JobPool& jobs) {
+        auto start = std::chrono::steady_clock::now();
+        nInstances = 0;
+        nOpaque = 0;
+        nPalettes = 0;
+        nBaked = 0;
+        snapshotTime = time;
+        requests.clear();
+        shared.clear();
+        size_t nJoints = std::max<size_t>(model.skeleton.size(), 1);
+        int idleClip = model.idleClip;
+        int walkClip = model.walkClip;
+        bool bBakedAvailable = model.vertexAnimation.is_baked();
+
+        // mesh instances are written opaque first, then the ones that fade into their impostor
+        float fadeEnd = impostorDistance + impostorFade;
+        uint32_t nFading = 0;
+        distances.resize(transforms.size());
+        impostors.clear();
+        for (size_t i = 0; i < transforms.size(); i++) {
+            distances[i] = glm::distance(viewPosition, transforms[i].position);
+            if (distances[i] < impostorDistance) nOpaque++;
+            else {
+                impostors.push_back(transforms[i]);
+                if (distances[i] < fadeEnd) nFading++;
+            }
+        }
+
+        instanceRange = streamBuffer.allocate((nOpaque + nFading) * sizeof(Instance), streamBuffer.storage_alignment());
+        if (!instanceRange || nOpaque + nFading == 0) return;
+        Instance* instances = (Instance*)instanceRange.data;
+        uint32_t iOpaque = 0;
+        uint32_t iFading = nOpaque;
+
+        for (size_t i = 0; i < transforms.size(); i++) {
+            RenderSnapshot::EnemyAnimation animation = i < animations.size() ? animations[i] : RenderSnapshot::EnemyAnimation();
+            float distance = distances[i];
+            if (distance >= fadeEnd) continue;
+            uint32_t slot = distance < impostorDistance ? iOpaque++ : iFading++;
+            if (bBakedAvailable && distance >= bakedDistance) {
+                // clip 0 of the vertex animation is idle, clip 1 walk
+                const VertexAnimation::Clip& clip = model.vertexAnimation.clips[animation.walkWeight >= 0.5f ? 1 : 0];
+                instances[slot] = {transforms[i].matrix(), glm::uvec4(bakedInstance, clip.firstFrame, clip.nFrames, std::bit_cast<uint32_t>(animation.time - time))};
+                nBaked++;
+                continue;
+            }
+            size_t lod = 0;
+            while (distance > lods[lod].distance) lod++;
+
+            Request request = {idleClip, walkClip, animation.time, animation.walkWeight};
+            uint32_t palette;
+            if (idleClip < 0) {
+                palette = shared_palette(0, request); // no clips, everybody shares the bind pose
+            }
+            else if (lods[lod].bBlend) {
+                palette = (uint32_t)requests.size();
+                requests.push_back(request);
+            }
+            else {
+                int clip = animation.walkWeight >= 0.5f ? walkClip : idleClip;
+                uint32_t step = (uint32_t)(animation.time / lods[lod].timeStep);
+                request = {clip, clip, step * lods[lod].timeStep, 0.0f};
+                palette = shared_palette(((uint64_t)(clip + 1) << 40) | ((uint64_t)lod << 32) | step, request);
+            }
+            instances[slot] = {transforms[i].matrix(), glm::uvec4(palette * (uint32_t)nJoints, 0, 0, 0)};
+        }
+
+        paletteRange = streamBuffer.allocate(requests.size() * nJoints * sizeof(glm::mat4), streamBuffer.storage_alignment());
+        if (!paletteRange) return;
+        glm::mat4* palettes = (glm::mat4*)paletteRange.data;
+        auto evaluate = [&](size_t begin, size_t end) {
+            thread_local Pose pose;
+            thread_local std::vector<glm::mat4> globals;
+            thread_local std::vector<glm::mat4> palette;
+            palette.resize(nJoints, glm::mat4(1.0f));
+            for (size_t r = begin; r < end; r++) {
+                const Request& request = requests[r];
+                pose.reset(model.skeleton);
+                if (request.clipA >= 0)
+                    model.clips[request.clipA].sample(request.time, pose);
+                if (request.clipB >= 0 && request.clipB != request.clipA && request.weight > 0.0f)
+                    model.clips[request.clipB].sample(request.time, pose, request.weight);
+                if (model.skeleton.size() > 0)
+                    compute_palette(model.skeleton, pose, palette.data(), globals);
+                std::copy(palette.begin(), palette.end(), palettes + r * nJoints); // the mapping is write only, never read it back
+            }
+        };
+        jobs.parallel_for(requests.size(), 16, evaluate);
+        nInstances = nOpaque + nFading;
+        nPalettes = (uint32_t)requests.size();
+        lastUpdateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // binds instances, palettes and the time of the baked instances for the SKINNING shaders
+    void bind(GLuint streamBuffer) const {
+        glUniform1f(43, snapshotTime);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, streamBuffer, instanceRange.offset, instanceRange.size);
+        if (paletteRange.size > 0) // all baked
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, streamBuffer, paletteRange.offset, paletteRange.size);
+    }
+
+    uint32_t get_instance_count() const { return nInstances; } // drawn as meshes
+    uint32_t get_opaque_count() const { return nOpaque; }      // the first ones, the rest cross-fades
+    uint32_t get_palette_count() const { return nPalettes; } // evaluated poses this frame
+    uint32_t get_baked_count() const { return nBaked; }
+
+    float bakedDistance = 40.0f; // 0 = all instances baked, FLT_MAX = all skinned
+    float impostorDistance = FLT_MAX; // start of the cross-fade
+    float impostorFade = 5.0f;
+    std::vector<Transform> impostors; // instances beyond impostorDistance
+    float lastUpdateMs = 0.0f;   // CPU time of the last update
+
+private:
+    static constexpr uint32_t bakedInstance = 0xFFFFFFFFu; // marks baked instances in the shaders
+    struct Instance {
+        glm::mat4 modelMatrix;
+        glm::uvec4 animation; // skinned: x = first palette matrix; baked: x = bakedInstance, y = first frame, z = frame count, w = time offset
+    };
+    struct Request {
+        int clipA; // base clip
+        int clipB; // blended on top by weight
+        float time;
+        float weight;
+    };
+
+    uint32_t shared_palette(uint64_t key, const Request& request) {
+        auto [it, bInserted] = shared.try_emplace(key, (uint32_t)requests.size());
+        if (bInserted)
+            requests.push_back(request);
+        return it->second;
+    }
+
+    std::vector<float> distances;
+    std::vector<Request> requests; // one per palette
+    std::unordered_map<uint64_t, uint32_t> shared;
+    StreamBuffer::Allocation instanceRange;
+    StreamBuffer::Allocation paletteRange;
+    uint32_t nInstances = 0;
+    uint32_t nOpaque = 0;
+    uint32_t nPalettes = 0;
+    uint32_t nBaked = 0;
+    float snapshotTime = 0.0f;
+};
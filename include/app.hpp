@@ -11,6 +11,8 @@
 // C++ standard library
 #include <vector>
 #include <iostream>
+#include <atomic>
+#include <thread>
 // Project-local headers
 using namespace gl;
 #include "utils.hpp"
@@ -18,6 +20,29 @@ using namespace gl;
 #include "pipeline.hpp"
 #include "input.hpp"
 #include "timer.hpp"
+#include "triple_buffer.hpp"
+#include "render_snapshot.hpp"
+#include "frame_arena.hpp"
+#include "allocation_counter.hpp"
+#include "latency.hpp"
+#include "frame_pacer.hpp"
+#include "app_options.hpp"
+#include "input_recording.hpp"
+#include "benchmark.hpp"
+#include "gpu_timer.hpp"
+#include "pipeline_statistics.hpp"
+#include "render_stats.hpp"
+#include "gl_debug.hpp"
+#include "clustered_lighting.hpp"
+#include "render_target.hpp"
+#include "resolution_scaling.hpp"
+#include "stream_buffer.hpp"
+#include "particle_system.hpp"
+#include "job_pool.hpp"
+#include "animation_system.hpp"
+#include "impostor.hpp"
+#include "grass.hpp"
+#include "terrain_chunks.hpp"
 // #include "audio.hpp" // ToDo: Comment again when SDL3_Mixer is working
 
 #include "game_objects/model.hpp"
@@ -26,6 +51,10 @@ using namespace gl;
 #include "game_objects/skybox.hpp"
 
 #include "enemy_system/enemy_system.hpp"
+#include "enemy_system/wave_director.hpp"
+#include "enemy_system/flow_field.hpp"
+#include "enemy_system/crowd.hpp"
+#include "enemy_system/vision.hpp"
 #include "game_objects/player.hpp"
 #include <Jolt/Jolt.h>
 
@@ -35,8 +64,30 @@ using namespace gl;
 
 struct App
 {
-    App()
+    App(const AppOptions &options = AppOptions()) : options(options)
     {
+        // a replay brings its own seed, otherwise the seed is stored with the recording
+        if (!options.replayPath.empty() && recording.load(options.replayPath))
+        {
+            bReplaying = true;
+            if (recording.tickRate != simulationRate)
+                std::cerr << "Recording was made with " << recording.tickRate << " ticks per second, the replay will diverge" << std::endl;
+        }
+        else
+        {
+            recording.seed = options.seed;
+            recording.tickRate = simulationRate;
+            bRecording = !options.recordPath.empty();
+            if (bRecording)
+                recording.entries.reserve(1 << 16);
+        }
+        enemySystem.set_seed(recording.seed);
+
+        if (!options.benchmarkScene.empty())
+            setup_benchmark();
+        zombieAnimation.bakedDistance = options.crowdBakedDistance;
+        zombieAnimation.impostorDistance = options.impostorDistance;
+
         // create frame buffer for shadow mapping pipeline
         glCreateFramebuffers(1, &shadowPipeline.framebuffer);
         // attach texture to frame buffer (only draw to depth, no color output!)
@@ -45,56 +96,330 @@ struct App
 
         skyboxPipeline.bind();
 
-        // Spawn Zombies
-        enemySystem.spawnEnemys();
+        // the simulation keeps its own copy of the light states and hands them to the renderer via snapshots
+        for (auto &light : lights)
+            lightStates.push_back({light.transform.position, light.lightColor});
+
+        place_lamps();
+
+        // the walls and the standing parts of the level are obstacles for the enemy pathfinding (wall cube mesh spans [-1, 1])
+        for (auto &wall : player.map.walls)
+            flowField.add_obstacle(wall.transform.position - wall.transform.scale, wall.transform.position + wall.transform.scale);
+        for (auto &model : models)
+            add_level_obstacles(model);
+        std::cout << "Pathfinding: " << flowField.count_blocked() << " of " << flowField.get_size_x() * flowField.get_size_z() << " cells blocked" << std::endl;
+        if (flowField.count_blocked() == 0)
+            std::cerr << "No obstacles registered, zombies walk straight towards the player" << std::endl;
+
         std::cout << "All models loaded!" << std::endl;
     }
 
+    // The calling thread owns the GL context and renders, the game itself is simulated on a second thread
     int run()
     {
+        if (options.bHeadless && bReplaying)
+            return run_headless();
+
+        std::thread simulationThread(&App::simulate, this);
+
         while (bRunning)
         {
-            Input::flush(); // flush input from last frame
-            timer.update(); // update delta time
+            uint64_t allocationsBefore = AllocationCounter::get();
+            RenderStats::get().reset();
+            ShaderCache::get().poll(); // hot reload in dev builds
+            streamBuffer.begin_frame();
+            poll_events();
+
+            // grab the newest finished simulation tick (never waits for the simulation thread)
+            const RenderSnapshot &frame = snapshots.read();
+            if (SDL_GetRelativeMouseMode() != frame.bMouseCaptured)
+                SDL_SetRelativeMouseMode(frame.bMouseCaptured);
+            if (bLowLatency != frame.bLowLatency)
+                set_low_latency(frame.bLowLatency);
+            if (framePacer.get_target_fps() != frame.targetFps)
+                framePacer.set_target_fps(frame.targetFps);
+            if (glTraceRequests != frame.glTraceRequests)
+            {
+                glTraceRequests = frame.glTraceRequests;
+                GlTracer::start("gl_trace.csv");
+            }
+
+            // Show the respective screen and the UI
+            imgui_begin();
+            switch (frame.screen)
+            {
+            case RenderSnapshot::Screen::eStart:
+                draw_start_ui();
+                break;
+            case RenderSnapshot::Screen::eGame:
+                if (benchmark.scene == BenchmarkScene::eShadows)
+                    bShadowmapsRendered = false;
+                draw(frame);
+                draw_ui(frame);
+                break;
+            case RenderSnapshot::Screen::eEnd:
+                draw_end_ui(frame);
+                break;
+            }
+            begin_pass(RenderStats::Pass::eUI);
+            imgui_end();
+            end_pass(RenderStats::Pass::eUI);
+            streamBuffer.end_frame();
 
-            SDL_Event event;
-            while (SDL_PollEvent(&event))
+            // present drawn frame to the screen (blocks on vsync, but only the render thread)
+            window.swap();
+            GlTracer::end_frame();
+            if (bLowLatency)
+                queueLimiter.after_swap();
+            uint64_t swapTime = SDL_GetTicksNS();
+            latencyProbe.record(std::max(frame.inputTimestamp, latchedTimestamp), swapTime);
+            if (bLowLatency)
+                latencyProbe.log(swapTime);
+            renderAllocations = AllocationCounter::get() - allocationsBefore;
+
+            framePacer.end_frame(); // wait for the target frame time (if limited)
+
+            if (benchmark.scene != BenchmarkScene::eNone && frame.screen == RenderSnapshot::Screen::eGame)
             {
-                if (event.type == SDL_EventType::SDL_EVENT_QUIT)
+                RenderStats &stats = RenderStats::get();
+                RenderStats::Counters total = stats.total();
+                benchmark.record({(float)framePacer.timer.get_delta_ms(), total.drawCalls, total.triangles, renderAllocations, frame.simulationAllocations, zombieAnimation.lastUpdateMs}, stats);
+                if (benchmark.finished())
+                {
+                    std::array<Benchmark::PassQueries, RenderStats::nPasses> queries;
+                    for (size_t i = 0; i < RenderStats::nPasses; i++)
+                        queries[i] = {passTimers[i].totalMs, passTimers[i].nSamples, passStatistics[i].total, passStatistics[i].nSamples};
+                    benchmark.write_report(queries);
                     bRunning = false;
-                ImGui_ImplSDL3_ProcessEvent(&event);
-                window.handle_event(event);   // handle window resize and such events
-                Input::register_event(event); // handle keyboard/mouse events
+                }
             }
+        }
+
+        simulationThread.join();
+        if (bRecording)
+        {
+            recording.nTicks = simulationTick;
+            recording.save(options.recordPath);
+        }
+        cleanup();
+        return 0;
+    }
+
+    // Runs a replay without rendering as fast as possible and prints the tick times
+    int run_headless()
+    {
+        std::cout << "Headless replay of " << recording.nTicks << " ticks (seed " << recording.seed << ")" << std::endl;
+        auto start = Timer::clock::now();
+        simulate(false);
+        double seconds = std::chrono::duration<double>(Timer::clock::now() - start).count();
+
+        FrameTimeStats stats = tickTimes.stats();
+        std::cout << simulationTick << " ticks in " << seconds << " s (" << seconds * 1000.0 / std::max(simulationTick, 1u) << " ms per tick)" << std::endl;
+        std::cout << "tick time of the last " << tickTimes.size() << " ticks: p50 " << stats.p50 << " / p95 " << stats.p95 << " / p99 " << stats.p99 << " / max " << stats.max << " ms" << std::endl;
+        std::cout << enemySystem.enemies.size() << " zombies left, wave " << waveDirector.wave << ", player health " << player.health << std::endl;
+        std::cout << "cpu particles: " << headlessParticles.alive << " alive, " << headlessParticleMs / std::max(simulationTick, 1u) << " ms per update" << std::endl;
+        cleanup();
+        return 0;
+    }
+
+private:
+    // Scripted scene of the --benchmark mode, skips the main menu and ignores live input
+    void setup_benchmark()
+    {
+        benchmark.scene = parse_benchmark_scene(options.benchmarkScene);
+        if (benchmark.scene == BenchmarkScene::eNone)
+        {
+            std::cerr << "Unknown benchmark scene " << options.benchmarkScene << std::endl;
+            return;
+        }
+        benchmark.sceneName = options.benchmarkScene;
+        benchmark.duration = options.benchmarkDuration;
+        benchmark.bDepthPrepass = options.bDepthPrepass;
+        benchmark.crowdAnimation = options.crowdAnimation;
+        benchmark.impostorDistance = options.impostorDistance;
+        benchmark.outputPath = options.benchmarkOutput.empty() ? "benchmark_" + options.benchmarkScene + ".json" : options.benchmarkOutput;
+        std::cout << "Benchmark " << benchmark.sceneName << " for " << benchmark.duration << " s" << std::endl;
+
+        startScreen = false;
+        gameScreen = true;
+        firstStart = true;
+        window.set_swap_interval(0); // measure uncapped
+
+        if (benchmark.scene == BenchmarkScene::eZombies)
+            benchmark.nZombies = enemySystem.spawnEnemys(1000, player.position);
+        if (benchmark.scene == BenchmarkScene::eCrowd)
+            benchmark.nZombies = enemySystem.spawnEnemys(4000, player.position);
+        if (benchmark.nZombies > 0)
+            std::cout << benchmark.nZombies << " zombies spawned" << std::endl;
+
+        if (benchmark.scene == BenchmarkScene::eLights)
+        {
+            // 512 lights on a grid over the map, moved in circles by update_benchmark
+            glm::vec3 minBounds = player.map.getMinBounds();
+            glm::vec3 maxBounds = player.map.getMaxBounds();
+            for (int z = 0; z < 16; z++)
+                for (int x = 0; x < 32; x++)
+                {
+                    glm::vec3 position = glm::vec3(glm::mix(minBounds.x, maxBounds.x, (x + 0.5f) / 32.0f), 1.0f,
+                                                   glm::mix(minBounds.z, maxBounds.z, (z + 0.5f) / 16.0f));
+                    glm::vec3 color = glm::vec3((x % 3) == 0, (x % 3) == 1, (z % 2) == 0) + glm::vec3(0.2f);
+                    benchmarkLights.push_back({position, 3.0f, color});
+                }
+        }
+
+        if (benchmark.scene == BenchmarkScene::eFire)
+        {
+            weapon.isAutomatic = true;
+            weapon.shotRate = 1;
+            weapon.magazine = weapon.bullets = 1000000;
+            // one shot per tick: 60 per second, each flies 2.5 s, more than the 128 slots of the pool hold
+            weapon.projectiles.maxFlyDistance = 250.f;
+        }
+    }
+
+    // Per tick script of the benchmark scenes (simulation thread, after the regular input handling)
+    void update_benchmark()
+    {
+        if (benchmark.scene == BenchmarkScene::eFire)
+            shoot();
+
+        if (benchmark.scene == BenchmarkScene::eParticles)
+        {
+            // 5 x 300 particles per tick with 1.2 s lifetime keep about 100k alive
+            glm::vec3 minBounds = player.map.getMinBounds();
+            glm::vec3 maxBounds = player.map.getMaxBounds();
+            for (uint32_t i = 0; i < 5; i++)
+            {
+                uint32_t state = simulationTick * 5 + i;
+                float x = particle_random(state);
+                float z = particle_random(state);
+                glm::vec3 position = glm::vec3(glm::mix(minBounds.x, maxBounds.x, x), 1.5f, glm::mix(minBounds.z, maxBounds.z, z));
+                emit_particles(ParticleEffect::eDeath, position, glm::vec3(0.0f, 1.0f, 0.0f), 300);
+            }
+        }
+
+        if (benchmark.scene == BenchmarkScene::eLights)
+        {
+            float time = simulationTick * tickDelta;
+            for (size_t i = 0; i < benchmarkLights.size(); i++)
+            {
+                float angle = time + i * 0.37f;
+                benchmarkLights[i].position.x += std::cos(angle) * tickDelta;
+                benchmarkLights[i].position.z += std::sin(angle) * tickDelta;
+            }
+        }
+
+        if (benchmark.scene == BenchmarkScene::eFlythrough || benchmark.scene == BenchmarkScene::eCrowd)
+        {
+            // circle over the map, looking at its center
+            float radius = player.map.getMaxBounds().x * 0.6f;
+            float angle = simulationTick * tickDelta * 0.2f;
+            float pi = 3.14159265358979323846f;
+            camera.position = glm::vec3(std::cos(angle) * radius, 12.0f, std::sin(angle) * radius);
+            camera.rotation = glm::vec3(-0.3f, pi * 0.5f - angle, 0.0f);
+            camera.update_view();
+            weaponTransform = weapon_transform(camera.position, camera.rotation);
+        }
+    }
+
+    // Called on the render thread, hands keyboard/mouse events to the simulation thread
+    void poll_events()
+    {
+        SDL_Event event;
+        while (SDL_PollEvent(&event))
+        {
+            if (event.type == SDL_EventType::SDL_EVENT_QUIT)
+                bRunning = false;
+            ImGui_ImplSDL3_ProcessEvent(&event);
+            window.handle_event(event); // handle window resize and such events
+            Input::push_event(event);   // keyboard/mouse events are consumed by the simulation thread
+
+            // remember recent mouse motion for late-latching the camera
+            if (event.type == SDL_EventType::SDL_EVENT_MOUSE_MOTION)
+            {
+                recentMotion[recentMotionIndex] = {event.common.timestamp, event.motion.xrel, event.motion.yrel};
+                recentMotionIndex = (recentMotionIndex + 1) % recentMotion.size();
+            }
+        }
+    }
+
+    // Low latency mode: adaptive vsync (or tearing), at most one queued frame and late-latched camera rotation
+    void set_low_latency(bool bEnable)
+    {
+        bLowLatency = bEnable;
+        window.set_swap_interval(bEnable ? -1 : 1);
+        if (!bEnable)
+            queueLimiter.reset();
+        std::cout << "Low latency mode " << (bEnable ? "on" : "off") << std::endl;
+    }
+
+    // Applies the mouse motion the simulation has not seen yet to the snapshot's camera rotation,
+    // called right before the color pass so the view uses the freshest input
+    glm::vec3 latch_camera_rotation(const RenderSnapshot &frame)
+    {
+        latchedTimestamp = 0;
+        if (!bLowLatency || !frame.bMouseCaptured)
+            return frame.cameraRotation;
+
+        poll_events();
+        glm::vec3 rotation = frame.cameraRotation;
+        for (auto &motion : recentMotion)
+        {
+            if (motion.timestamp <= frame.inputTimestamp)
+                continue;
+            rotation.x -= frame.lookSpeed * motion.dy;
+            rotation.y -= frame.lookSpeed * motion.dx;
+            latchedTimestamp = std::max(latchedTimestamp, motion.timestamp);
+        }
+        return rotation;
+    }
+
+    // Simulation loop, runs at a fixed tick rate independent of the display (weapon timings are counted in ticks),
+    // with bRealtime = false the ticks run back to back (headless replays)
+    void simulate(bool bRealtime = true)
+    {
+        auto nextTick = Timer::clock::now();
+        while (bRunning)
+        {
+            auto tickStart = Timer::clock::now();
+            frameArena.reset(); // free all transient data of the last tick
+            uint64_t allocationsBefore = AllocationCounter::get();
+
+            // flush input from last tick and apply the queued (or replayed) events
+            if (bReplaying)
+            {
+                Input::discard();
+                if (!recording.replay(simulationTick, SDL_GetTicksNS()))
+                    bRunning = false;
+            }
+            else if (benchmark.scene != BenchmarkScene::eNone)
+                Input::discard();
+            else if (bRecording)
+                Input::poll([&](const Input::Event &event) { recording.record(simulationTick, event); });
+            else
+                Input::poll();
 
-            // Show the respective screen and the UI
             if (startScreen)
             {
                 if (firstStart)
                 {
-                    SDL_SetRelativeMouseMode(false);
+                    bMouseCaptured = false;
                     firstStart = false;
                 }
 
-                imgui_begin();
-                draw_start_ui();
                 handle_inputs_startScreen();
-                imgui_end();
             }
             else if (gameScreen)
             {
                 if (firstStart)
                 {
-                    SDL_SetRelativeMouseMode(true);
+                    bMouseCaptured = true;
                     firstStart = false;
                 }
 
                 handle_inputs();
-                imgui_begin();
-                draw();
-                //draw_ui();    //Attention!: If this is commented in, the UI is there, but sometimes it crashes when spawning/deleting objects
-                imgui_end();
-                
+                if (benchmark.scene != BenchmarkScene::eNone)
+                    update_benchmark();
                 weapon.update();
                 updateGame();
             }
@@ -102,24 +427,90 @@ struct App
             {
                 if (firstStart)
                 {
-                    SDL_SetRelativeMouseMode(false);
+                    bMouseCaptured = false;
                     firstStart = false;
                 }
 
-                imgui_begin();
-                draw_end_ui();
                 handle_inputs_endScreen();
-                imgui_end();
             }
 
-            // present drawn frame to the screen
-            window.swap();
+            simulationAllocations = AllocationCounter::get() - allocationsBefore;
+            publish_snapshot();
+            if (options.bHeadless)
+                update_headless_particles();
+            simulationTick++;
+            tickTimes.push((float)std::chrono::duration<double, std::milli>(Timer::clock::now() - tickStart).count());
+
+            if (bRealtime)
+            {
+                nextTick += std::chrono::microseconds(1000000 / simulationRate);
+                precise_sleep_until(nextTick);
+            }
         }
+    }
 
-        return 0;
+    // Copies the current simulation state into the next free snapshot and hands it to the render thread
+    void publish_snapshot()
+    {
+        RenderSnapshot &frame = snapshots.write();
+        if (startScreen)
+            frame.screen = RenderSnapshot::Screen::eStart;
+        else if (gameScreen)
+            frame.screen = RenderSnapshot::Screen::eGame;
+        else
+            frame.screen = RenderSnapshot::Screen::eEnd;
+        frame.bMouseCaptured = bMouseCaptured;
+        frame.bWireframe = bWireframe;
+        frame.bLowLatency = bLowLatencyRequested;
+        frame.bDepthPrepass = bDepthPrepassRequested;
+        frame.renderScale = options.renderScale;
+        frame.bDynamicResolution = bDynamicResolutionRequested;
+        frame.targetFps = frameLimits[frameLimitIndex];
+        frame.glTraceRequests = glTraceRequested;
+
+        frame.cameraPosition = camera.position;
+        frame.cameraRotation = camera.rotation;
+        frame.lookSpeed = player.rotationSpeed;
+        frame.inputTimestamp = Input::Data::get().timestamp;
+        frame.time = simulationTick * tickDelta;
+
+        frame.weapon = weaponTransform;
+        frame.enemies.clear();
+        frame.enemyAnimations.clear();
+        for (auto &enemy : enemySystem.enemies)
+        {
+            frame.enemies.push_back(enemy.transform);
+            frame.enemyAnimations.push_back({enemy.animationTime + enemy.ID * 0.37f, enemy.walkWeight}); // zombies do not walk in lockstep
+        }
+        frame.projectiles.clear();
+        weapon.projectiles.for_each([&](Projectile &projectile) {
+            frame.projectiles.emplace_back(projectile.position, projectile.rotation, glm::vec3(0.2f));
+        });
+        frame.lights.assign(lightStates.begin(), lightStates.end());
+        // bursts stay in the snapshots for a few ticks, so the renderer sees them even if it skips snapshots
+        std::erase_if(particleBursts, [&](const ParticleBurst &burst) { return burst.tick + burstHistoryTicks <= simulationTick; });
+        frame.particleBursts.assign(particleBursts.begin(), particleBursts.end());
+        frame.pointLights.assign(lamps.begin(), lamps.end());
+        frame.pointLights.insert(frame.pointLights.end(), benchmarkLights.begin(), benchmarkLights.end());
+        if (muzzleFlashTicks > 0)
+        {
+            muzzleFlashTicks--;
+            frame.pointLights.push_back({weaponTransform.position, 6.0f, glm::vec3(4.0f, 2.6f, 1.2f)});
+        }
+
+        frame.health = player.health;
+        frame.stamina = player.stamina;
+        frame.bullets = weapon.bullets;
+        frame.magazine = weapon.magazine;
+        frame.zombiesLeft = enemySystem.enemies.size();
+        frame.zombiesKilled = player.zombiesKilled;
+        frame.wave = waveDirector.wave;
+        frame.crowdAgents = crowd.size();
+        frame.crowdUpdateMs = crowd.lastUpdateMs;
+        frame.simulationAllocations = simulationAllocations;
+        snapshots.publish();
     }
 
-private:
     void imgui_begin()
     {
         ImGui_ImplOpenGL3_NewFrame();
@@ -131,7 +522,14 @@ private:
     {
         ImGui::Render();
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        // ImGui issues its own draw calls, count them for the ui pass
+        ImDrawData *drawData = ImGui::GetDrawData();
+        RenderStats::Counters &counters = RenderStats::get().counters();
+        for (int i = 0; i < drawData->CmdListsCount; i++)
+            counters.drawCalls += drawData->CmdLists[i]->CmdBuffer.Size;
+        counters.triangles += drawData->TotalIdxCount / 3;
+
+        ImGui_ImplOpenGL3_RenderDrawData(drawData);
 
     }
 
@@ -159,14 +557,42 @@ private:
         ImGui::End();
     }
 
-    void draw_ui()
+    void draw_ui(const RenderSnapshot &frame)
     {
         // Performance stats
         ImGui::SetNextWindowBgAlpha(0.35f);
         ImGui::SetNextWindowPos({20, 20});
         ImGui::Begin("FPS_Overlay", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+        FrameTimeStats frameTimes = framePacer.stats();
         ImGui::Text("%.1f fps", ImGui::GetIO().Framerate);
         ImGui::Text("%.1f ms", ImGui::GetIO().DeltaTime * 1000.0f);
+        ImGui::Text("p50 %.1f / p95 %.1f / p99 %.1f / max %.1f ms", frameTimes.p50, frameTimes.p95, frameTimes.p99, frameTimes.max);
+        if (frame.targetFps > 0.0f)
+            ImGui::Text("frame limit: %.0f fps", frame.targetFps);
+        ImGui::Text("clustered lights: %d", (int)clusteredLighting.get_light_count());
+        ImGui::Text("zombies: %d meshes, %d poses evaluated, %d baked (%.3f ms), %d impostors", (int)zombieAnimation.get_instance_count(), (int)zombieAnimation.get_palette_count(),
+                    (int)zombieAnimation.get_baked_count(), zombieAnimation.lastUpdateMs, (int)zombieImpostor.get_count());
+        ImGui::Text("terrain: %d chunks drawn, %d resident, %d generating", (int)terrainChunks.get_drawn_count(), (int)terrainChunks.get_resident_count(), (int)terrainChunks.get_pending_count());
+        if (options.bGrass)
+            ImGui::Text("grass: %d tiles around the camera, %d blades max", (int)(Grass::windowTiles * Grass::windowTiles), (int)Grass::capacity);
+        ImGui::Text("particles: %d%s", (int)particles.get_count(), options.bCpuParticles ? " (cpu)" : "");
+        ImGui::Text("stream buffer: %d KiB peak per frame", (int)(streamBuffer.get_peak_usage() / 1024));
+        ImGui::Text("render scale: %.0f%%%s", renderScale * 100.0f, frame.bDynamicResolution ? " (dynamic)" : "");
+        ImGui::Text("crowd: %d agents, %.3f ms", (int)frame.crowdAgents, frame.crowdUpdateMs);
+        if (AllocationCounter::enabled)
+            ImGui::Text("heap allocs: %d tick / %d frame", (int)frame.simulationAllocations, (int)renderAllocations);
+        ImGui::Text("input latency: %.1f ms%s", latencyProbe.lastMs, bLowLatency ? " (low latency)" : "");
+        if (GlTracer::active())
+            ImGui::Text("tracing GL calls...");
+        // per pass workload of the current frame (ui of the last one) and GPU numbers from a few frames ago
+        for (size_t i = 0; i < RenderStats::nPasses; i++)
+        {
+            const RenderStats::Counters &counters = RenderStats::get().passes[i];
+            ImGui::Text("%-9s %.2f ms, %d draws, %d tris, %d/%d/%d binds", RenderStats::passNames[i], passTimers[i].lastMs, (int)counters.drawCalls, (int)counters.triangles,
+                        (int)counters.pipelineBinds, (int)counters.materialBinds, (int)counters.transformBinds);
+            if (PipelineStatisticsQuery::supported() && passStatistics[i].nSamples > 0)
+                ImGui::Text("       %llu vs, %llu fs invocations", (unsigned long long)passStatistics[i].last.vertexInvocations, (unsigned long long)passStatistics[i].last.fragmentInvocations);
+        }
         ImGui::End();
 
         // Crosshair
@@ -179,10 +605,10 @@ private:
         ImGui::SetNextWindowSize(player_window_size);
         ImGui::Begin("Player stats", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
         ImGui::Text("Player");
-        ImGui::Text("%.1f HP", player.health);
-        ImGui::Text("%.1f Stamina", player.stamina);
+        ImGui::Text("%.1f HP", frame.health);
+        ImGui::Text("%.1f Stamina", frame.stamina);
         ImGui::Text("Munition");
-        ImGui::Text("%.d / %.d", weapon.bullets, weapon.magazine);
+        ImGui::Text("%.d / %.d", frame.bullets, frame.magazine);
         ImGui::End();
 
         // Gameplay info
@@ -190,12 +616,13 @@ private:
         ImGui::SetNextWindowPos({ImGui::GetIO().DisplaySize.x - (gameplay_window_size.x + 20), 20});
         ImGui::SetNextWindowSize(gameplay_window_size);
         ImGui::Begin("Gameplay info", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
-        ImGui::Text("%d Zombies left", enemySystem.enemies.size());
-        ImGui::Text("%d Zombies killed", player.zombiesKilled);
+        ImGui::Text("Wave %d", frame.wave);
+        ImGui::Text("%d Zombies left", (int)frame.zombiesLeft);
+        ImGui::Text("%d Zombies killed", frame.zombiesKilled);
         ImGui::End();
     }
 
-    void draw_end_ui()
+    void draw_end_ui(const RenderSnapshot &frame)
     {
         ImVec2 end_window_size = {750, 500};
         ImGui::SetNextWindowPos({(ImGui::GetIO().DisplaySize.x / 2) - (end_window_size.x / 2), (ImGui::GetIO().DisplaySize.y / 2) - (end_window_size.y / 2)});
@@ -208,9 +635,8 @@ private:
         textCentered("You have died!");
         ImGui::Text("");
         char buffer[50];
-        std::sprintf(buffer, "Your score is: %d", player.zombiesKilled);
-        std::string tmpText = buffer;
-        textCentered(tmpText);
+        std::snprintf(buffer, sizeof(buffer), "Your score is: %d", frame.zombiesKilled);
+        textCentered(buffer);
         ImGui::Text("");
         ImGui::Text("");
         ImGui::Text("");
@@ -218,9 +644,29 @@ private:
         ImGui::End();
     }
 
-    void draw()
+    void draw(const RenderSnapshot &frame)
     {
+        // draw wireframe while holding f
+        if (frame.bWireframe)
+            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        else
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+        // apply simulated light states
+        for (size_t iLight = 0; iLight < lights.size() && iLight < frame.lights.size(); iLight++)
+        {
+            lights[iLight].transform.position = frame.lights[iLight].position;
+            lights[iLight].lightColor = frame.lights[iLight].color;
+        }
+
+        // skinning palettes of all zombies, shared by all passes of this frame
+        zombieAnimation.update(zombieModel, frame.enemies, frame.enemyAnimations, frame.time, frame.cameraPosition, streamBuffer, jobPool);
+        zombieImpostor.update(zombieAnimation.impostors, streamBuffer);
+
         // first pass: render shadow map
+        bool bShadowPass = !bShadowmapsRendered;
+        if (bShadowPass)
+            begin_pass(RenderStats::Pass::eShadow);
         glBindFramebuffer(GL_FRAMEBUFFER, shadowPipeline.framebuffer);
         shadowPipeline.bind();
         // for each light
@@ -237,23 +683,10 @@ private:
                 glClear(GL_DEPTH_BUFFER_BIT);
                 // bind resources to pipeline
                 lights[iLight].bind_write(face);
+                RenderStats::get().shadowFaces++;
 
                 // draw models
-                for (auto &model : models)
-                    model.draw();
-
-                for (auto &projectiles : weapon.projectilesList) {
-                    projectiles.draw();
-                }
-
-                weaponModel.draw();
-
-                // draw Enemys
-                for (auto &enemy : enemySystem.enemies)
-                    enemy.draw();
-
-                for (auto &wall : player.map.walls)
-                    wall.draw();
+                draw_objects(frame);
 
                 // draw other light models
                 for (size_t i = 0; i < lights.size(); i++)
@@ -261,45 +694,186 @@ private:
                     if (i != iLight)
                         lights[i].draw();
                 }
+
+                // skinned zombies (own program, so the light uniforms are bound again)
+                skinnedShadowPipeline.bind();
+                lights[iLight].bind_write(face);
+                draw_zombies(0, zombieAnimation.get_instance_count());
+                shadowPipeline.bind();
             }
         }
         bShadowmapsRendered = true;
+        if (bShadowPass)
+            end_pass(RenderStats::Pass::eShadow);
 
-        // second pass: render color map
-        glViewport(0, 0, window.width, window.height);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // second pass: render color map (offscreen, at the render scale)
+        update_render_scale(frame);
+        sceneTarget.bind(renderScale);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, skyboxPipeline.framebuffer);
-        // glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        begin_pass(RenderStats::Pass::eSkybox);
         skyboxPipeline.bind();
         // set framebuffer texture and clear it
         skybox.bind();
         // glUniform1i(glGetUniformLocation(2, "skybox"), 0);
+        end_pass(RenderStats::Pass::eSkybox);
+
+        // camera of this frame, shared by depth and color pass
+        renderCamera.position = frame.cameraPosition;
+        renderCamera.rotation = latch_camera_rotation(frame);
+        renderCamera.update_view();
+        terrainChunks.update(renderCamera.position);
+
+        // optional depth pre-pass: only depth, so the color pass shades each pixel at most once
+        if (frame.bDepthPrepass)
+        {
+            begin_pass(RenderStats::Pass::eDepth);
+            depthPipeline.bind();
+            renderCamera.bind();
+            glColorMask(false, false, false, false);
+            draw_objects(frame);
+            terrainChunks.draw(renderCamera);
+            for (auto &light : lights)
+                light.draw();
+            skinnedDepthPipeline.bind();
+            renderCamera.bind();
+            draw_zombies(0, zombieAnimation.get_opaque_count()); // the cross-fading ones are not opaque
+            glColorMask(true, true, true, true);
+            end_pass(RenderStats::Pass::eDepth);
+        }
 
+        begin_pass(RenderStats::Pass::eColor);
+        // sort the point lights into the clusters of this view (binds the culling compute shader)
+        clusteredLighting.update(frame.pointLights, renderCamera, streamBuffer);
         colorPipeline.bind();
-        // bind resources to pipeline
-        camera.bind();
-        for (size_t iLight = 0; iLight < lights.size(); iLight++)
+        bind_color_resources();
+        if (frame.bDepthPrepass)
         {
-            lights[iLight].bind_read(iLight, iLight + 1);
+            // depth is final already, only the visible surface passes
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(false);
         }
 
         // draw models
         for (auto &light : lights)
             light.draw();
 
-        for (auto &model : models)
-            model.draw();
+        draw_objects(frame);
+        terrainChunks.draw(renderCamera);
+        skinnedColorPipeline.bind();
+        bind_color_resources();
+        glUniform2f(46, 0.0f, 0.0f); // no dithering
+        draw_zombies(0, zombieAnimation.get_opaque_count());
+        if (frame.bDepthPrepass)
+        {
+            glDepthFunc(GL_LESS);
+            glDepthMask(true); // the next glClear needs depth writes
+        }
 
-        for (auto &projectiles : weapon.projectilesList) {
-            projectiles.draw();
+        // far zombies: dithered cross-fade from mesh to impostor, then impostors only (not in the depth pre-pass)
+        glm::vec2 fadeRange = glm::vec2(zombieAnimation.impostorDistance, zombieAnimation.impostorDistance + zombieAnimation.impostorFade);
+        glUniform2f(46, fadeRange.x, fadeRange.y);
+        draw_zombies(zombieAnimation.get_opaque_count(), zombieAnimation.get_instance_count() - zombieAnimation.get_opaque_count());
+        if (zombieImpostor.get_count() > 0)
+        {
+            zombieImpostor.bind(renderCamera, streamBuffer.buffer);
+            for (size_t iLight = 0; iLight < lights.size(); iLight++)
+                lights[iLight].bind_read(iLight, iLight + 1);
+            zombieImpostor.draw(fadeRange);
         }
+        if (options.bGrass)
+        {
+            // blades of the visible tiles around the camera, spawned on the GPU for this view
+            grass.update(renderCamera);
+            grass.bind(renderCamera, frame.time);
+            for (size_t iLight = 0; iLight < lights.size(); iLight++)
+                lights[iLight].bind_read(iLight, iLight + 1);
+            grass.draw();
+        }
+        end_pass(RenderStats::Pass::eColor);
+
+        // particles on top of the opaque scene (emitted from the snapshot bursts, simulated with the render frame time)
+        begin_pass(RenderStats::Pass::eParticles);
+        particles.emit(frame.particleBursts, streamBuffer);
+        particles.update(std::min(framePacer.timer.get_delta(), 0.1f));
+        particles.draw(renderCamera, sceneTarget, streamBuffer);
+        end_pass(RenderStats::Pass::eParticles);
+
+        // last pass: upscale to the window, the UI is drawn on top at native resolution
+        begin_pass(RenderStats::Pass::eUpscale);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, window.width, window.height);
+        upscaler.draw(sceneTarget, renderScale, renderScale < 1.0f ? sharpness : 0.0f);
+        end_pass(RenderStats::Pass::eUpscale);
+    }
 
-        weaponModel.draw();
+    // Camera, shadow casters and clustered lights of the color pass (uniforms are per program, so once per color pipeline)
+    void bind_color_resources()
+    {
+        renderCamera.bind();
+        clusteredLighting.bind(renderCamera, (float)sceneTarget.scaled_width(renderScale), (float)sceneTarget.scaled_height(renderScale));
+        for (size_t iLight = 0; iLight < lights.size(); iLight++)
+        {
+            lights[iLight].bind_read(iLight, iLight + 1);
+        }
+    }
 
-        for (auto &enemy : enemySystem.enemies)
-            enemy.draw();
+    // Zombie meshes with one instanced draw per mesh (a SKINNING pipeline has to be bound), skinned and baked alike.
+    // The instance buffer holds the opaque zombies first, then the ones that cross-fade into their impostors.
+    void draw_zombies(uint32_t first, uint32_t count)
+    {
+        if (count == 0)
+            return;
+        zombieAnimation.bind(streamBuffer.buffer);
+        zombieModel.draw_instanced(count, first);
+    }
+
+    // Fixed render scale, or one that follows the GPU time of the previous frames
+    void update_render_scale(const RenderSnapshot &frame)
+    {
+        if (!frame.bDynamicResolution)
+        {
+            renderScale = frame.renderScale;
+            dynamicResolution.scale = renderScale;
+            return;
+        }
+        // the shadow maps are only rendered once, their (old) time would hold the scale down forever
+        float gpuMs = 0.0f;
+        for (size_t i = (size_t)RenderStats::Pass::eSkybox; i < RenderStats::nPasses; i++)
+            if (i != (size_t)RenderStats::Pass::eDepth || frame.bDepthPrepass)
+                gpuMs += passTimers[i].lastMs;
+        float budgetMs = 1000.0f / (frame.targetFps > 0.0f ? frame.targetFps : 60.0f);
+        renderScale = dynamicResolution.update(gpuMs, budgetMs);
+    }
+
+    // Everything counted or measured until end_pass belongs to this pass
+    void begin_pass(RenderStats::Pass pass)
+    {
+        RenderStats::get().begin_pass(pass);
+        passTimers[(size_t)pass].begin();
+        passStatistics[(size_t)pass].begin();
+    }
+    void end_pass(RenderStats::Pass pass)
+    {
+        passTimers[(size_t)pass].end();
+        passStatistics[(size_t)pass].end();
+    }
+
+    // Draws every model of the scene, the dynamic ones at the instance transforms of the snapshot
+    void draw_objects(const RenderSnapshot &frame)
+    {
+        for (auto &model : models)
+            model.draw();
+
+        for (auto &projectile : frame.projectiles)
+            projectileModel.draw(projectile);
+
+        // follow the late-latched camera, otherwise the weapon would lag behind the view
+        if (latchedTimestamp != 0)
+            weaponModel.draw(weapon_transform(renderCamera.position, renderCamera.rotation));
+        else
+            weaponModel.draw(frame.weapon);
 
         for (auto &wall : player.map.walls)
             wall.draw();
@@ -349,14 +923,13 @@ private:
         {
             std::cout << "restart game" << std::endl;
 
-            cleanup();
-            std::exit(0);      
+            bRunning = false; // cleanup happens on the render thread once the simulation has stopped
         }
     }
 
     void cleanup() {
 
-        weapon.projectilesList.clear();
+        weapon.projectiles.clear();
         player.map.walls.clear();
         enemySystem.enemies.clear();
     }
@@ -364,17 +937,34 @@ private:
     void handle_inputs()
     {
         // draw wireframe while holding f
-        if (Keys::down('f'))
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        else
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        bWireframe = Keys::down('f');
 
         // capture mouse for better camera controls
         if (Keys::pressed(SDL_KeyCode::SDLK_ESCAPE))
-            SDL_SetRelativeMouseMode(!SDL_GetRelativeMouseMode());
+            bMouseCaptured = !bMouseCaptured;
+
+        // toggle low latency mode
+        if (Keys::pressed('l'))
+            bLowLatencyRequested = !bLowLatencyRequested;
+
+        // cycle through the frame limits
+        if (Keys::pressed('p'))
+            frameLimitIndex = (frameLimitIndex + 1) % frameLimits.size();
+
+        // toggle the depth pre-pass
+        if (Keys::pressed('z'))
+            bDepthPrepassRequested = !bDepthPrepassRequested;
+
+        // toggle dynamic resolution
+        if (Keys::pressed('v'))
+            bDynamicResolutionRequested = !bDynamicResolutionRequested;
+
+        // trace the GL calls of the next frames
+        if (GlTracer::enabled && Keys::pressed('g'))
+            glTraceRequested++;
 
         // player movement
-        float movementSpeed = timer.get_delta() * player.movementSpeed;
+        float movementSpeed = tickDelta * player.movementSpeed;
         
         // sprint button
         if (Keys::down(SDL_KeyCode::SDLK_LSHIFT) && player.stamina > 0.5f)
@@ -396,27 +986,14 @@ private:
             weapon.reload();
 
         if (Mouse::down(1))
-        {
-            Ray ray = raycastHit.getRaycast(window, camera);
+            shoot();
 
-            if (weapon.fire())
-            {
-                weapon.shootProjectile(player.position, player.rotation);
-
-                for (auto &enemie : enemySystem.enemies)
-                    if (raycastHit.isCollision(ray, enemie.sphereCollider))
-                        enemie.hit(100.0f);
-            }
-            else
-            {
-                weapon.noFire();
-            }
-        }
-
-        // Gravity and jumping
+        // Gravity and jumping, relative to the ground below the player
+        float eyeHeight = 2.0f;  // Camera above the ground
         float jumpHeight = 5.0f; // Maximum height of the jump
         float jumpSpeed = 0.1f;  // Speed of the jump
         float gravity = 0.05f;   // Gravity
+        float ground = player.map.height(player.position);
 
         if (Keys::down(32) && onGround)
             jumping = true;
@@ -424,11 +1001,11 @@ private:
         if (jumping)
         {
             player.move(0.0f, jumpSpeed, 0.0f);
-            if (jumpHeight < player.position.y)
+            if (ground + jumpHeight < player.position.y)
                 jumping = false;
         }
 
-        if (player.position.y > 2)
+        if (player.position.y > ground + eyeHeight)
             onGround = false;
         else
             onGround = true;
@@ -436,7 +1013,7 @@ private:
         if (!onGround)
             player.move(0.0f, -gravity, 0.0f);
         else
-            player.position.y = 2;
+            player.position.y = ground + eyeHeight;
 
         // Player movement calculation
         player.rotation.x -= player.rotationSpeed * Mouse::delta().second;
@@ -445,14 +1022,9 @@ private:
         // Sync Camera and Player
         camera.position = player.position;
         camera.rotation = player.rotation;
+        camera.update_view();
 
-        // Calculate the new position of the weapon based on the camera rotation and the offset position
-        glm::vec3 weaponPosition = camera.position + (glm::quat(camera.rotation) * glm::vec3(0.25f, -0.5f, -1.0f));
-
-        float pi = 3.14159265358979323846f;
-
-        weaponModel.transform.position = weaponPosition;
-        weaponModel.transform.rotation = glm::vec3(camera.rotation.y + pi, -camera.rotation.x, camera.rotation.z); 
+        weaponTransform = weapon_transform(camera.position, camera.rotation);
 
         // Test buttons
         /*if (Keys::down('l'))
@@ -462,24 +1034,151 @@ private:
         // if (Keys::pressed('r')) Mix_PlayChannel(-1, audio.samples[0], 0);
     }
 
+    // Blocks the cells below every mesh of the level that stands on the ground and is taller than a zombie's knee.
+    // Meshes as large as a quarter of the arena are the ground itself (or enclose it) and are skipped.
+    void add_level_obstacles(const Model &level)
+    {
+        glm::mat4 matrix = level.transform.matrix();
+        float maxSize = (player.map.getMaxBounds().x - player.map.getMinBounds().x) * 0.25f;
+        for (const Mesh &mesh : level.get_meshes())
+        {
+            glm::vec3 minimum = glm::vec3(FLT_MAX);
+            glm::vec3 maximum = glm::vec3(-FLT_MAX);
+            for (const Vertex &vertex : mesh.get_vertices())
+            {
+                glm::vec3 position = glm::vec3(matrix * glm::vec4(vertex.pos, 1.0f));
+                minimum = glm::min(minimum, position);
+                maximum = glm::max(maximum, position);
+            }
+            if (minimum.x > maximum.x)
+                continue; // no vertices
+            bool bStanding = minimum.y < 0.5f && maximum.y > 1.0f;
+            bool bGround = maximum.x - minimum.x > maxSize || maximum.z - minimum.z > maxSize;
+            if (bStanding && !bGround)
+                flowField.add_obstacle(minimum, maximum);
+        }
+    }
+
+    // Places warm and cold lamps on a grid over the map (unshadowed, culled per cluster)
+    void place_lamps()
+    {
+        glm::vec3 minBounds = player.map.getMinBounds();
+        glm::vec3 maxBounds = player.map.getMaxBounds();
+        std::array<glm::vec3, 3> colors = {glm::vec3(1.0f, 0.6f, 0.3f), glm::vec3(0.4f, 0.6f, 1.0f), glm::vec3(0.8f, 1.0f, 0.6f)};
+        int nLamps = 0;
+        for (float z = minBounds.z + 2.0f; z <= maxBounds.z - 2.0f; z += 6.0f)
+            for (float x = minBounds.x + 2.0f; x <= maxBounds.x - 2.0f; x += 6.0f)
+                lamps.push_back({glm::vec3(x, 1.5f, z), 5.0f, colors[nLamps++ % colors.size()]});
+    }
+
+    // Queues a particle effect for the renderer
+    void emit_particles(ParticleEffect effect, glm::vec3 position, glm::vec3 direction, uint32_t count)
+    {
+        particleBursts.push_back({position, simulationTick, direction, count, effect});
+    }
+
+    // Headless replays have no renderer, the CPU particles are simulated per tick instead
+    void update_headless_particles()
+    {
+        for (auto &burst : particleBursts)
+            if (burst.tick == simulationTick)
+                headlessParticles.emit(burst);
+        auto start = Timer::clock::now();
+        headlessParticles.update(tickDelta);
+        headlessParticleMs += std::chrono::duration<double, std::milli>(Timer::clock::now() - start).count();
+    }
+
+    // Fires the weapon if it is ready, hits every enemy along the view ray
+    void shoot()
+    {
+        Ray ray = raycastHit.getRaycast(window, camera);
+
+        if (weapon.fire())
+        {
+            weapon.shootProjectile(player.position, player.rotation);
+            muzzleFlashTicks = 3;
+            emit_particles(ParticleEffect::eMuzzleFlash, weaponTransform.position + ray.dir * 0.6f, ray.dir, 24);
+
+            for (auto &enemie : enemySystem.enemies)
+                if (raycastHit.isCollision(ray, enemie.sphereCollider))
+                {
+                    enemie.hit(100.0f);
+                    emit_particles(ParticleEffect::eHit, enemie.sphereCollider.center, -ray.dir, 48);
+                }
+        }
+        else
+        {
+            weapon.noFire();
+        }
+    }
+
+    // Calculate the new position of the weapon based on the camera rotation and the offset position
+    static Transform weapon_transform(glm::vec3 cameraPosition, glm::vec3 cameraRotation)
+    {
+        glm::vec3 weaponPosition = cameraPosition + (glm::quat(cameraRotation) * glm::vec3(0.25f, -0.5f, -1.0f));
+
+        float pi = 3.14159265358979323846f;
+
+        return Transform(weaponPosition, glm::vec3(cameraRotation.y + pi, -cameraRotation.x, cameraRotation.z), {0.2f, 0.2f, 0.2f});
+    }
+
     // Updates the movement of enemies and projectiles, also checks whether an object needs to be deleted
     void updateGame()
     {
+        // Spawn Zombies
+        waveDirector.update(tickDelta, enemySystem, player.position);
+
+        // only rebuilt when the player entered another cell
+        flowField.update(player.position);
+
+        // separation forces and vision checks for all zombies at once, based on the positions of the last tick
+        crowd.resize(enemySystem.enemies.size());
+        vision.resize(enemySystem.enemies.size());
+        size_t iAgent = 0;
         for (auto &enemy : enemySystem.enemies)
         {
-            // Check if player is seen by enemy
-            if (enemy.isPlayerInSight(player.position))
+            vision.ids[iAgent] = enemy.ID;
+            crowd.posX[iAgent] = vision.posX[iAgent] = enemy.transform.position.x;
+            crowd.posZ[iAgent] = vision.posZ[iAgent] = enemy.transform.position.z;
+            vision.forwardX[iAgent] = enemy.forward.x;
+            vision.forwardZ[iAgent] = enemy.forward.z;
+            iAgent++;
+        }
+        crowd.update();
+        vision.update(player.position, simulationTick, [this](glm::vec3 from, glm::vec3 to) {
+            return !flowField.line_of_sight(from, to);
+        });
+
+        std::pmr::vector<int> deadEnemies(frameArena.get()); // lives in the frame arena, freed by the next reset
+        iAgent = 0;
+        for (auto &enemy : enemySystem.enemies)
+        {
+            // Check if player is seen by enemy, the first sight starts the chase (walls and turns around them don't stop it)
+            enemy.playerVisible = vision.visible[iAgent];
+            enemy.chasing = enemy.chasing || enemy.playerVisible;
+            if (enemy.chasing)
             {
-                //  Move Enemy towards Player
-                glm::vec3 direction = glm::normalize(player.position - enemy.transform.position);
-                enemy.rotateTowards(player.position);
+                //  Move Enemy towards Player along the flow field, directly once it shares the player's cell
+                glm::vec3 direction = flowField.chase_direction(enemy.transform.position, player.position);
+                if (direction != glm::vec3(0.0f))
+                    enemy.rotateTowards(enemy.transform.position + direction);
 
-                float movementSpeed = timer.get_delta() * enemy.movementSpeed;
+                float movementSpeed = tickDelta * enemy.movementSpeed;
                 enemy.transform.position += direction * movementSpeed;
-                enemy.transform.position.y = 0.f;
-                enemy.sphereCollider.center = enemy.transform.position;
-                enemy.sphereCollider.center.y = 2.5f;
             }
+            // Push apart from the other zombies
+            enemy.transform.position.x += crowd.forceX[iAgent] * separationStrength * tickDelta;
+            enemy.transform.position.z += crowd.forceZ[iAgent] * separationStrength * tickDelta;
+            enemy.transform.position.y = player.map.height(enemy.transform.position);
+            enemy.sphereCollider.center = enemy.transform.position;
+            enemy.sphereCollider.center.y += 2.5f;
+            iAgent++;
+
+            // animation state for the renderer
+            enemy.animationTime += tickDelta;
+            float walkTarget = enemy.chasing ? 1.0f : 0.0f;
+            enemy.walkWeight += std::clamp(walkTarget - enemy.walkWeight, -4.0f * tickDelta, 4.0f * tickDelta);
+
             // Check if player is hit by enemy
             float distanceToEnemy = glm::distance(player.position, enemy.transform.position);
             float collisionRadius = 2.5f;
@@ -492,40 +1191,22 @@ private:
             if (enemy.died)
             {
                 player.zombiesKilled++;
-                deleteEnemyIndex.push_back(enemy.ID);
+                deadEnemies.push_back(enemy.ID);
+                emit_particles(ParticleEffect::eDeath, enemy.transform.position + glm::vec3(0.0f, 1.5f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 300);
             }
         }
 
         // Delete the dead zombies
-        for (size_t i = 0; i < deleteEnemyIndex.size(); ++i) {
-            enemySystem.deleteEnemies(deleteEnemyIndex[i], enemySystem.enemies);
-            deleteEnemyIndex.erase(deleteEnemyIndex.begin() + i);   
-        }
+        for (int id : deadEnemies)
+            enemySystem.deleteEnemies(id, enemySystem.enemies);
 
-        // Update projectiles
-        for (auto &projectiles : weapon.projectilesList)
-        {
-            if (projectiles.maxFlyDistanceAchieved())
-            {
-                deleteProjectileIndex.push_back(projectiles.ID);
-            }
-            else
-            {
-                float movementSpeed = timer.get_delta() * projectiles.movementSpeed;
-                projectiles.move(0.0f, 0.0f, -movementSpeed);
-            }
-        }
-
-        // Deletes balls that have reached the target distance
-        for (size_t i = 0; i < deleteProjectileIndex.size(); ++i) {
-            weapon.deleteProjectile(deleteProjectileIndex[i], weapon.projectilesList);
-            deleteProjectileIndex.erase(deleteProjectileIndex.begin() + i);   
-        }
+        // Update projectiles, the ones that reached the target distance are freed by the pool
+        weapon.projectiles.update(tickDelta);
 
         // Add Player stamina
         player.increaseStamina(.08f);
 
-        if (!player.isAlive()) 
+        if (!player.isAlive() && benchmark.scene == BenchmarkScene::eNone) // benchmarks keep running
             loseGame();
     }
 
@@ -542,36 +1223,106 @@ private:
 
 private:
 
-    void textCentered(std::string text)
+    void textCentered(const char *text)
     {
         auto windowWidth = ImGui::GetWindowSize().x;
-        auto textWidth = ImGui::CalcTextSize(text.c_str()).x;
+        auto textWidth = ImGui::CalcTextSize(text).x;
 
         ImGui::SetCursorPosX((windowWidth - textWidth) * 0.5f);
-        ImGui::Text(text.c_str());
+        ImGui::TextUnformatted(text);
     }
 
-    Timer timer;
-    Window window = Window(1280, 720, 4);
-    bool bRunning = true;
+    AppOptions options;
+    Window window = Window(1280, 720, 4, options.bHeadless);
+    std::atomic<bool> bRunning = true;
     bool bShadowmapsRendered = false;
+    // thread handoff
+    static constexpr int simulationRate = 60; // ticks per second
+    static constexpr float tickDelta = 1.0f / simulationRate; // fixed time step, keeps the simulation deterministic
+    FrameTimeHistory tickTimes;
+    // input recording/replay
+    InputRecording recording;
+    bool bRecording = false;
+    bool bReplaying = false;
+    TripleBuffer<RenderSnapshot> snapshots;
+    bool bMouseCaptured = true;
+    bool bWireframe = false;
+    bool bLowLatencyRequested = false; // simulation side
+    bool bDepthPrepassRequested = options.bDepthPrepass; // simulation side
+    bool bDynamicResolutionRequested = options.bDynamicResolution; // simulation side
+    std::array<float, 5> frameLimits = {0.0f, 30.0f, 60.0f, 120.0f, 144.0f};
+    size_t frameLimitIndex = 0;
+    uint32_t glTraceRequested = 0; // simulation side
+    uint32_t glTraceRequests = 0;  // render side
+    FramePacer framePacer; // render thread
+    // low latency mode (render thread)
+    struct Motion
+    {
+        uint64_t timestamp;
+        float dx, dy;
+    };
+    bool bLowLatency = false;
+    std::array<Motion, 64> recentMotion = {};
+    size_t recentMotionIndex = 0;
+    uint64_t latchedTimestamp = 0;
+    FrameQueueLimiter queueLimiter;
+    LatencyProbe latencyProbe;
+    // per pass GPU times and pipeline statistics
+    std::array<GpuTimer, RenderStats::nPasses> passTimers;
+    std::array<PipelineStatisticsQuery, RenderStats::nPasses> passStatistics;
+    Benchmark benchmark;
     // render resources
-    Pipeline colorPipeline = Pipeline("shaders/default.vs", "shaders/default.fs");
+    static constexpr size_t maxShadowLights = 1; // shadow casters, everything else goes through the clustered lights
+    Pipeline colorPipeline = Pipeline("shaders/default.vs", "shaders/default.fs", {"SHADOW_QUALITY 2", "N_LIGHTS " + std::to_string(maxShadowLights), "CLUSTERED_LIGHTING"});
     Pipeline shadowPipeline = Pipeline("shaders/shadowmapping.vs", "shaders/shadowmapping.fs");
+    Pipeline depthPipeline = Pipeline({{GL_VERTEX_SHADER, "shaders/shadowmapping.vs"}}); // position only, no fragment shader
+    // instanced GPU skinning permutations of the three passes
+    Pipeline skinnedColorPipeline = Pipeline("shaders/default.vs", "shaders/default.fs", {"SHADOW_QUALITY 2", "N_LIGHTS " + std::to_string(maxShadowLights), "CLUSTERED_LIGHTING", "SKINNING"});
+    Pipeline skinnedShadowPipeline = Pipeline("shaders/shadowmapping.vs", "shaders/shadowmapping.fs", {"SKINNING"});
+    Pipeline skinnedDepthPipeline = Pipeline({{GL_VERTEX_SHADER, "shaders/shadowmapping.vs"}}, {"SKINNING"});
     Pipeline skyboxPipeline = Pipeline("shaders/skybox.vs", "shaders/skybox.fs");
     Skybox skybox = Skybox();
 
-    Player player = Player({1, 2, 1}, {0, 0, 0}, 100.f, 100.f, 2.f, 3.f, 0.001f);
+    Player player = Player({1, 2, 1}, {0, 0, 0}, 100.f, 100.f, 2.f, 3.f, 0.001f, options.arenaSize);
     Camera camera = Camera({1, 2, 1}, {0, 0, 0}, window.width, window.height);
+    Camera renderCamera = Camera({1, 2, 1}, {0, 0, 0}, window.width, window.height); // only used by the render thread
 
-    std::array<PointLight, 1> lights = {
+    std::array<PointLight, maxShadowLights> lights = {
         PointLight({10, 20, 0}, {0, 0, 0}, {1, 1, 1}, 100.0f),
     };
+    std::vector<RenderSnapshot::LightState> lightStates;
+    // unshadowed point lights (simulation side): lamps placed over the map, muzzle flash, benchmark lights
+    std::vector<RenderSnapshot::PointLightState> lamps;
+    std::vector<RenderSnapshot::PointLightState> benchmarkLights;
+    uint32_t muzzleFlashTicks = 0;
+    // particle effects of the last ticks (simulation side)
+    static constexpr uint32_t burstHistoryTicks = 8;
+    std::vector<ParticleBurst> particleBursts;
+    CpuParticles headlessParticles = CpuParticles(options.bHeadless ? ParticleSystem::gpuCapacity : 0); // measured by headless replays
+    double headlessParticleMs = 0.0;
+    StreamBuffer streamBuffer = StreamBuffer(4 << 20); // per frame data of all render passes (lights, particles, skinning palettes)
+    ClusteredLighting clusteredLighting; // render thread
+    ParticleSystem particles = ParticleSystem(options.bCpuParticles); // render thread
+    JobPool jobPool; // render thread helpers
+    AnimationSystem zombieAnimation;
+    // the 3D passes render offscreen at renderScale and are upscaled to the window (render thread)
+    RenderTarget sceneTarget = RenderTarget(window.width, window.height);
+    Upscaler upscaler;
+    DynamicResolution dynamicResolution;
+    float renderScale = 1.0f;
+    float sharpness = 0.5f;
 
     Model weaponModel = Model({1, 1, 1}, {0, 0, 0}, {0.2f, 0.2f, 0.2f}, "models/weapon/M4a1.obj");
+    Transform weaponTransform = Transform({1, 1, 1}, {0, 0, 0}, {0.2f, 0.2f, 0.2f});
+    // shared models for all instances of a kind, loaded once and drawn at the snapshot transforms
+    Model zombieModel = Model({0, 0, 0}, {0, 0, 0}, {1, 1, 1}, "models/zombie/Enemy Zombie.obj", true); // skinned, drawn instanced
+    Impostor zombieImpostor = Impostor(zombieModel, maxShadowLights); // baked from zombieModel
+    Grass grass = Grass(player.map.getMinBounds(), player.map.getMaxBounds(), player.map.heightfield, maxShadowLights); // render thread
+    TerrainChunks terrainChunks = TerrainChunks(player.map.heightfield); // render thread, generates on its own worker
+    Model projectileModel = Model({0, 0, 0}, {0, 0, 0}, {1, 1, 1}, "models/test/cube.obj");
 
     std::array<Model, 1> models = {        
-        Model({0, 0, 0}, {0, 0, 0}, {1, 1, 1}, "models/Environment/environment_low3.obj"),
+        Model({0, 0, 0}, {0, 0, 0}, {1, 1, 1}, options.benchmarkScene == "flythrough" ? "models/Environment/environment_high.obj" : "models/Environment/environment_low3.obj"),
         //Model({0, 0, 0}, {0, 0, 0}, {1, 1, 1}, "models/test/cube.obj"), //"TestMap" for faster start of the game
     };
 
@@ -579,11 +1330,21 @@ private:
     RaycastHit raycastHit;
 
     //  Audio audio; //ToDo: Comment again when SDL3_Mixer is working
-    EnemySystem enemySystem = EnemySystem(7);
+    EnemySystem enemySystem = options.benchmarkScene == "crowd"
+        ? EnemySystem(4096, player.map.getMinBounds(), player.map.getMaxBounds(), 1337, 0.8f) // packed densely enough for 4000
+        : EnemySystem(1024, player.map.getMinBounds(), player.map.getMaxBounds(), 1337);
+    WaveDirector waveDirector = WaveDirector(7, 1.5f, 30.f); // first wave size, growth per wave, seconds between waves
+    FlowField flowField = FlowField(player.map.getOuterMinBounds(), player.map.getOuterMaxBounds(), 1.0f); // covers the walls
+    Crowd crowd = Crowd(player.map.getMinBounds(), player.map.getMaxBounds(), 1.0f);
+    float separationStrength = 4.0f;
+    Vision vision = Vision(90.f, 40.f); // field of view in degrees, sight distance
+    uint32_t simulationTick = 0;
 
     bool onGround = true;
     bool jumping = false;
 
-    std::vector<int> deleteProjectileIndex;
-    std::vector<int> deleteEnemyIndex;
+    // transient per-tick data
+    FrameArena frameArena = FrameArena(64 * 1024);
+    uint64_t simulationAllocations = 0;
+    uint64_t renderAllocations = 0;
 };
\ No newline at end of file
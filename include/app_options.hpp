@@ -0,0 +1,133 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <random>
+#include <cstdint>
+#include <cfloat>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdlib>
+
+// Command line options
+struct AppOptions {
+    static AppOptions parse(int argc, char **argv) {
+        AppOptions options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            bool bHasValue = i + 1 < argc;
+            if (arg == "--seed" && bHasValue) {
+                options.seed = number<uint32_t>(arg, argv[++i]);
+            }
+            else if (arg == "--record" && bHasValue) {
+                options.recordPath = argv[++i];
+            }
+            else if (arg == "--replay" && bHasValue) {
+                options.replayPath = argv[++i];
+            }
+            else if (arg == "--headless") {
+                options.bHeadless = true;
+            }
+            else if (arg == "--benchmark" && bHasValue) {
+                options.benchmarkScene = argv[++i];
+            }
+            else if (arg == "--duration" && bHasValue) {
+                options.benchmarkDuration = number<float>(arg, argv[++i]);
+            }
+            else if (arg == "--output" && bHasValue) {
+                options.benchmarkOutput = argv[++i];
+            }
+            else if (arg == "--no-depth-prepass") {
+                options.bDepthPrepass = false;
+            }
+            else if (arg == "--render-scale" && bHasValue) {
+                options.renderScale = std::clamp(number<float>(arg, argv[++i]), 0.5f, 1.0f);
+            }
+            else if (arg == "--dynamic-resolution") {
+                options.bDynamicResolution = true;
+            }
+            else if (arg == "--cpu-particles") {
+                options.bCpuParticles = true;
+            }
+            else if (arg == "--crowd-animation" && bHasValue) {
+                options.crowdAnimation = argv[++i];
+                if (options.crowdAnimation == "skinned") options.crowdBakedDistance = FLT_MAX;
+                else if (options.crowdAnimation == "vat") options.crowdBakedDistance = 0.0f;
+                else options.crowdAnimation = "auto";
+            }
+            else if (arg == "--impostor-distance" && bHasValue) {
+                options.impostorDistance = std::max(number<float>(arg, argv[++i]), 0.0f);
+            }
+            else if (arg == "--no-impostors") {
+                options.impostorDistance = FLT_MAX;
+            }
+            else if (arg == "--arena-size" && bHasValue) {
+                options.arenaSize = std::max(number<int>(arg, argv[++i]), 10);
+            }
+            else if (arg == "--no-grass") {
+                options.bGrass = false;
+            }
+            else {
+                std::cerr << "Unknown option " << arg << std::endl;
+                print_usage();
+            }
+        }
+        if (options.bHeadless && options.replayPath.empty()) {
+            std::cerr << "--headless needs a replay, ignored" << std::endl;
+            options.bHeadless = false;
+        }
+        return options;
+    }
+
+    static void print_usage() {
+        std::cerr << "Usage: [--seed <n>] [--record <file>] [--replay <file> [--headless]]" << std::endl;
+        std::cerr << "       [--benchmark <zombies|fire|flythrough|shadows|lights|particles|crowd> [--duration <seconds>] [--output <file.json>]] [--no-depth-prepass]" << std::endl;
+        std::cerr << "       [--render-scale <0.5-1>] [--dynamic-resolution] [--cpu-particles] [--crowd-animation <skinned|vat|auto>]" << std::endl;
+        std::cerr << "       [--impostor-distance <m> | --no-impostors] [--no-grass] [--arena-size <m>]" << std::endl;
+    }
+
+    // the whole value has to be a number in the range of T, otherwise the usage is printed and the program exits
+    template<typename T>
+    static T number(std::string_view option, const char *text) {
+        std::string_view value = text;
+        T result{};
+        bool bValid = false;
+        if constexpr (std::is_integral_v<T>) {
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+            bValid = error == std::errc() && end == value.data() + value.size();
+        }
+        else {
+            try { // std::from_chars for floats is missing in some standard libraries
+                size_t length = 0;
+                result = (T)std::stof(std::string(value), &length);
+                bValid = length == value.size();
+            }
+            catch (const std::logic_error &) {} // invalid_argument, out_of_range
+        }
+        if (!bValid) {
+            std::cerr << "Invalid value " << value << " for " << option << std::endl;
+            print_usage();
+            std::exit(1);
+        }
+        return result;
+    }
+
+    uint32_t seed = std::random_device()(); // enemy spawns, a replay uses the recorded seed
+    std::string recordPath; // save seed and input of this session
+    std::string replayPath; // play back a recorded session instead of live input
+    bool bHeadless = false; // replay as fast as possible without rendering
+    std::string benchmarkScene; // run a scripted scene and write a JSON report
+    float benchmarkDuration = 20.0f; // seconds
+    std::string benchmarkOutput; // default: benchmark_<scene>.json
+    bool bDepthPrepass = true; // lay down depth first, the color pass then shades every pixel once
+    float renderScale = 1.0f; // resolution of the 3D passes relative to the window
+    bool bDynamicResolution = false; // adjust the render scale to the GPU frame time
+    bool bCpuParticles = false; // simulate particles on the CPU instead of compute shaders
+    std::string crowdAnimation = "auto"; // zombies are skinned, play the baked vertex animation texture (vat), or auto: vat when far away
+    float crowdBakedDistance = 40.0f;
+    float impostorDistance = 50.0f; // zombies farther away cross-fade into camera facing impostors
+    bool bGrass = true; // GPU scattered grass blades around the camera
+    int arenaSize = 40; // meters from the middle to each side, bigger arenas reach into the hills of the terrain
+};
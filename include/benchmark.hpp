@@ -0,0 +1,141 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cfloat>
+//
+#include "frame_pacer.hpp"
+#include "render_stats.hpp"
+
+// Scripted scenarios of the --benchmark mode
+enum class BenchmarkScene { eNone, eZombies, eFire, eFlythrough, eShadows, eLights, eParticles, eCrowd };
+
+inline BenchmarkScene parse_benchmark_scene(const std::string &name) {
+    if (name == "zombies") return BenchmarkScene::eZombies;         // 1000 zombies chasing the player
+    if (name == "fire") return BenchmarkScene::eFire;               // continuous automatic fire, projectile pool stays full
+    if (name == "flythrough") return BenchmarkScene::eFlythrough;   // camera circles over environment_high.obj
+    if (name == "shadows") return BenchmarkScene::eShadows;         // shadow maps are re-rendered every frame
+    if (name == "lights") return BenchmarkScene::eLights;           // 512 moving clustered point lights
+    if (name == "particles") return BenchmarkScene::eParticles;     // about 100k particles alive
+    if (name == "crowd") return BenchmarkScene::eCrowd;             // 4000 animated zombies (spaced 0.8 m) seen from above, compare --crowd-animation skinned/vat
+    return BenchmarkScene::eNone;
+}
+
+// Collects per-frame measurements of a benchmark run and writes them as JSON report
+struct Benchmark {
+    struct Frame {
+        float frameMs;
+        uint64_t drawCalls;
+        uint64_t triangles;
+        uint64_t renderAllocations;
+        uint64_t simulationAllocations;
+        float animationMs; // CPU time of the zombie animation update
+    };
+    // GPU measurements of a pass (sums, averaged in the report)
+    struct PassQueries {
+        double gpuMs;
+        uint64_t nGpuSamples;
+        PipelineCounts pipeline;
+        uint64_t nPipelineSamples;
+    };
+
+    // frames of the warm-up (shader compilation, first shadow maps, ...) are not recorded
+    void record(const Frame &frame, const RenderStats &stats) {
+        if (nWarmupFrames > 0) {
+            nWarmupFrames--;
+            frames.reserve((size_t)(duration * 1000.0f)); // up to 1000 fps without reallocation
+            return;
+        }
+        frames.push_back(frame);
+        elapsed += frame.frameMs * 0.001f;
+        for (size_t i = 0; i < RenderStats::nPasses; i++)
+            passTotals[i] += stats.passes[i];
+        shadowFaces += stats.shadowFaces;
+    }
+
+    bool finished() const {
+        return elapsed >= duration;
+    }
+
+    void write_report(const std::array<PassQueries, RenderStats::nPasses> &queries) {
+        std::vector<float> frameTimes;
+        frameTimes.reserve(frames.size());
+        for (auto &frame : frames)
+            frameTimes.push_back(frame.frameMs);
+        std::sort(frameTimes.begin(), frameTimes.end());
+        auto percentile = [&](float p) {
+            return frameTimes.empty() ? 0.0f : frameTimes[std::min(frameTimes.size() - 1, (size_t)(p * frameTimes.size()))];
+        };
+        auto average = [&](auto member) {
+            double sum = 0.0;
+            for (auto &frame : frames)
+                sum += (double)(frame.*member);
+            return frames.empty() ? 0.0 : sum / frames.size();
+        };
+
+        std::ofstream file(outputPath);
+        file << "{\n";
+        file << "  \"scene\": \"" << sceneName << "\",\n";
+        file << "  \"depth_prepass\": " << (bDepthPrepass ? "true" : "false") << ",\n";
+        file << "  \"crowd_animation\": \"" << crowdAnimation << "\",\n";
+        file << "  \"zombies\": " << nZombies << ",\n";
+        file << "  \"impostor_distance\": " << (impostorDistance < FLT_MAX ? impostorDistance : -1.0f) << ",\n";
+        file << "  \"duration_s\": " << elapsed << ",\n";
+        file << "  \"frames\": " << frames.size() << ",\n";
+        file << "  \"frame_ms\": { \"avg\": " << average(&Frame::frameMs) << ", \"p50\": " << percentile(0.50f) << ", \"p95\": " << percentile(0.95f)
+             << ", \"p99\": " << percentile(0.99f) << ", \"max\": " << (frameTimes.empty() ? 0.0f : frameTimes.back()) << " },\n";
+        file << "  \"draw_calls\": " << average(&Frame::drawCalls) << ",\n";
+        file << "  \"triangles\": " << average(&Frame::triangles) << ",\n";
+        file << "  \"shadow_faces\": " << per_frame(shadowFaces) << ",\n";
+        file << "  \"animation_cpu_ms\": " << average(&Frame::animationMs) << ",\n";
+        file << "  \"passes\": {\n";
+        for (size_t i = 0; i < RenderStats::nPasses; i++) {
+            const RenderStats::Counters &counters = passTotals[i];
+            const PassQueries &query = queries[i];
+            auto per_sample = [](auto value, uint64_t nSamples) { return nSamples ? (double)value / nSamples : 0.0; };
+            file << "    \"" << RenderStats::passNames[i] << "\": { \"gpu_ms\": " << per_sample(query.gpuMs, query.nGpuSamples)
+                 << ", \"draw_calls\": " << per_frame(counters.drawCalls) << ", \"triangles\": " << per_frame(counters.triangles)
+                 << ", \"pipeline_binds\": " << per_frame(counters.pipelineBinds) << ", \"material_binds\": " << per_frame(counters.materialBinds)
+                 << ", \"transform_binds\": " << per_frame(counters.transformBinds);
+            if (query.nPipelineSamples > 0) {
+                file << ", \"vertices_submitted\": " << per_sample(query.pipeline.verticesSubmitted, query.nPipelineSamples)
+                     << ", \"primitives_submitted\": " << per_sample(query.pipeline.primitivesSubmitted, query.nPipelineSamples)
+                     << ", \"vertex_invocations\": " << per_sample(query.pipeline.vertexInvocations, query.nPipelineSamples)
+                     << ", \"fragment_invocations\": " << per_sample(query.pipeline.fragmentInvocations, query.nPipelineSamples)
+                     << ", \"clipping_output\": " << per_sample(query.pipeline.clippingOutput, query.nPipelineSamples);
+            }
+            file << " }" << (i + 1 < RenderStats::nPasses ? "," : "") << "\n";
+        }
+        file << "  },\n";
+        file << "  \"allocations\": { \"render_per_frame\": " << average(&Frame::renderAllocations) << ", \"simulation_per_tick\": " << average(&Frame::simulationAllocations) << " }\n";
+        file << "}\n";
+
+        if (file)
+            std::cout << "Benchmark report written to " << outputPath << std::endl;
+        else
+            std::cerr << "Failed to write benchmark report " << outputPath << std::endl;
+    }
+
+    BenchmarkScene scene = BenchmarkScene::eNone;
+    std::string sceneName;
+    std::string outputPath;
+    float duration = 20.0f; // seconds
+    int nWarmupFrames = 60;
+    bool bDepthPrepass = true;
+    std::string crowdAnimation;
+    float impostorDistance = FLT_MAX; // -1 in the report = off
+    int nZombies = 0; // spawned at the start, can be fewer than requested if the arena is full
+
+private:
+    double per_frame(uint64_t value) const {
+        return frames.empty() ? 0.0 : (double)value / frames.size();
+    }
+
+    std::vector<Frame> frames;
+    std::array<RenderStats::Counters, RenderStats::nPasses> passTotals = {};
+    uint64_t shadowFaces = 0;
+    float elapsed = 0.0f;
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+//
+#include "pipeline.hpp"
+#include "render_snapshot.hpp"
+#include "stream_buffer.hpp"
+#include "game_objects/camera.hpp"
+
+// Clustered forward lighting for many unshadowed point lights.
+// A compute pass sorts the lights into a froxel grid (screen tiles x exponential depth slices),
+// the color pass (default.fs with CLUSTERED_LIGHTING) then only shades the lights of the fragment's cluster.
+// Shadow casting lights are not part of this, they keep their own fixed budget (N_LIGHTS).
+struct ClusteredLighting {
+    static constexpr uint32_t gridX = 16;
+    static constexpr uint32_t gridY = 9;
+    static constexpr uint32_t gridZ = 24;
+    static constexpr uint32_t nClusters = gridX * gridY * gridZ;
+    static constexpr uint32_t maxLightsPerCluster = 64;
+    static constexpr uint32_t maxLights = 1024;
+
+    ClusteredLighting() {
+        glCreateBuffers(1, &clusterBuffer);
+        glCreateBuffers(1, &indexBuffer);
+        glNamedBufferStorage(clusterBuffer, nClusters * sizeof(GLuint), nullptr, BufferStorageMask::GL_NONE_BIT);
+        glNamedBufferStorage(indexBuffer, nClusters * maxLightsPerCluster * sizeof(GLuint), nullptr, BufferStorageMask::GL_NONE_BIT);
+    }
+    ~ClusteredLighting() {
+        glDeleteBuffers(1, &clusterBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+    }
+
+    // streams the lights of this frame and culls them against the clusters of the camera
+    void update(const std::vector<RenderSnapshot::PointLightState>& lights, const Camera& camera, StreamBuffer& streamBuffer) {
+        nLights = (uint32_t)std::min<size_t>(lights.size(), maxLights);
+        // binding an empty range is invalid, always allocate at least one light
+        lightRange = streamBuffer.allocate(std::max<uint32_t>(nLights, 1) * sizeof(GpuLight), streamBuffer.storage_alignment());
+        lightBuffer = streamBuffer.buffer;
+        if (!lightRange)
+            nLights = 0;
+        GpuLight* gpuLights = (GpuLight*)lightRange.data;
+        for (uint32_t i = 0; i < nLights; i++)
+            gpuLights[i] = {glm::vec4(lights[i].position, lights[i].radius), glm::vec4(lights[i].color, 1.0f)};
+
+        bind_buffers();
+        cullPipeline.bind();
+        glm::mat4x4 inverseProjection = glm::inverse(camera.projectionMatrix);
+        glUniformMatrix4fv(0, 1, false, glm::value_ptr(camera.viewMatrix));
+        glUniformMatrix4fv(1, 1, false, glm::value_ptr(inverseProjection));
+        glUniform4ui(2, gridX, gridY, gridZ, maxLightsPerCluster);
+        glUniform2f(3, camera.nearPlane, camera.farPlane);
+        glUniform1ui(4, nLights);
+        glDispatchCompute(1, 1, gridZ);
+        glMemoryBarrier(MemoryBarrierMask::GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // binds the cluster lists for the color pass (its pipeline has to be bound)
+    void bind(const Camera& camera, float screenWidth, float screenHeight) {
+        bind_buffers();
+        float logDepthRange = std::log(camera.farPlane / camera.nearPlane);
+        glUniform4ui(40, gridX, gridY, gridZ, maxLightsPerCluster);
+        glUniform4f(41, camera.nearPlane, camera.farPlane, gridZ / logDepthRange, -(float)gridZ * std::log(camera.nearPlane) / logDepthRange);
+        glUniform2f(42, screenWidth, screenHeight);
+    }
+
+    uint32_t get_light_count() const {
+        return nLights;
+    }
+
+private:
+    struct GpuLight {
+        glm::vec4 positionRadius;
+        glm::vec4 color;
+    };
+
+    void bind_buffers() {
+        if (lightRange)
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer, lightRange.offset, lightRange.size);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, clusterBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, indexBuffer);
+    }
+
+    Pipeline cullPipeline = Pipeline({{GL_COMPUTE_SHADER, "shaders/cluster_cull.comp"}}, {"CLUSTER_X 16", "CLUSTER_Y 9"});
+    GLuint lightBuffer = 0; // the stream buffer
+    StreamBuffer::Allocation lightRange;
+    GLuint clusterBuffer;
+    GLuint indexBuffer;
+    uint32_t nLights = 0;
+};
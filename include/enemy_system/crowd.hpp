@@ -0,0 +1,125 @@
+#pragma once
+
+// External libraries
+#include <glm/gtc/matrix_transform.hpp> // https://glm.g-truc.net/0.9.2/api/a00245.html
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+// Keeps zombies from stacking inside each other (boids-style separation).
+// Agents are kept in packed arrays and bucketed into a uniform grid with the separation radius as cell size,
+// so every agent only looks at the agents of its 3x3 neighbouring cells.
+struct Crowd
+{
+    Crowd(glm::vec3 minBounds, glm::vec3 maxBounds, float radius = 1.0f)
+        : originX(minBounds.x), originZ(minBounds.z), radius(radius)
+    {
+        sizeX = std::max(1, (int)std::ceil((maxBounds.x - minBounds.x) / radius));
+        sizeZ = std::max(1, (int)std::ceil((maxBounds.z - minBounds.z) / radius));
+        cellStart.resize((size_t)sizeX * sizeZ + 1);
+    }
+
+    // Sets the number of agents, positions have to be written to posX/posZ before calling update()
+    void resize(size_t nAgents)
+    {
+        posX.resize(nAgents);
+        posZ.resize(nAgents);
+        forceX.resize(nAgents);
+        forceZ.resize(nAgents);
+        agentCell.resize(nAgents);
+        sortedX.resize(nAgents);
+        sortedZ.resize(nAgents);
+    }
+
+    size_t size() const { return posX.size(); }
+
+    // Calculates the separation force of every agent (written to forceX/forceZ)
+    void update()
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t nAgents = size();
+
+        // counting sort of the agents into their cells, positions are copied so each cell row is contiguous
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+        for (size_t i = 0; i < nAgents; i++)
+        {
+            agentCell[i] = cell_index(posX[i], posZ[i]);
+            cellStart[agentCell[i] + 1]++;
+        }
+        for (size_t cell = 1; cell < cellStart.size(); cell++)
+            cellStart[cell] += cellStart[cell - 1];
+        cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < nAgents; i++)
+        {
+            int slot = cellFill[agentCell[i]]++;
+            sortedX[slot] = posX[i];
+            sortedZ[slot] = posZ[i];
+        }
+
+        // accumulate the forces, the three cells of a neighbour row form one contiguous range
+        float radius2 = radius * radius;
+        float invRadius2 = 1.0f / radius2;
+        for (size_t i = 0; i < nAgents; i++)
+        {
+            int cell = agentCell[i];
+            int x = cell % sizeX;
+            int z = cell / sizeX;
+            int x0 = std::max(x - 1, 0);
+            int x1 = std::min(x + 1, sizeX - 1);
+            float px = posX[i];
+            float pz = posZ[i];
+            float fx = 0.0f;
+            float fz = 0.0f;
+
+            for (int nz = std::max(z - 1, 0); nz <= std::min(z + 1, sizeZ - 1); nz++)
+            {
+                int first = cellStart[nz * sizeX + x0];
+                int last = cellStart[nz * sizeX + x1 + 1];
+                // branchless so the compiler can vectorize it, the agent itself contributes zero
+                for (int j = first; j < last; j++)
+                {
+                    float dx = px - sortedX[j];
+                    float dz = pz - sortedZ[j];
+                    float weight = std::max(radius2 - (dx * dx + dz * dz), 0.0f) * invRadius2;
+                    fx += dx * weight;
+                    fz += dz * weight;
+                }
+            }
+            forceX[i] = fx;
+            forceZ[i] = fz;
+        }
+
+        lastUpdateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // packed agent state
+    std::vector<float> posX;
+    std::vector<float> posZ;
+    std::vector<float> forceX;
+    std::vector<float> forceZ;
+
+    // metrics of the last update
+    float lastUpdateMs = 0.0f;
+
+private:
+    int cell_index(float x, float z) const
+    {
+        int cellX = std::clamp((int)std::floor((x - originX) / radius), 0, sizeX - 1);
+        int cellZ = std::clamp((int)std::floor((z - originZ) / radius), 0, sizeZ - 1);
+        return cellZ * sizeX + cellX;
+    }
+
+    float originX;
+    float originZ;
+    float radius;
+    int sizeX;
+    int sizeZ;
+
+    std::vector<int> cellStart; // prefix sum, agents of cell c are sorted[cellStart[c], cellStart[c + 1])
+    std::vector<int> cellFill;
+    std::vector<int> agentCell;
+    std::vector<float> sortedX;
+    std::vector<float> sortedZ;
+};
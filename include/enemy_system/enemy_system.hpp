@@ -5,75 +5,134 @@
 #include <glbinding/glbinding.h>
 #include <SDL.h>
 
-#include "game_objects/model.hpp"
 #include "enemy_system/enemy.hpp"
 
 #include <random>
+#include <vector>
 
-// Creates enemys and manages them in lists
+// Creates enemys and manages them in a preallocated pool (spawning never allocates or loads assets)
 struct EnemySystem
 {
-    EnemySystem(int count)
+    EnemySystem(int capacity, glm::vec3 minBounds, glm::vec3 maxBounds, uint32_t seed = 1337, float minSpawnDistance = 1.5f)
+        : capacity(capacity), minBounds(minBounds), maxBounds(maxBounds), random(seed), minSpawnDistance(minSpawnDistance)
     {
-        numberOfEnemies = count;
+        enemies.reserve(capacity);
+
+        // background grid for the Poisson-disk sampling, cell size r/sqrt(2) so every cell holds at most one sample
+        gridCellSize = minSpawnDistance / std::sqrt(2.0f);
+        gridSizeX = std::max(1, (int)std::ceil((maxBounds.x - minBounds.x) / gridCellSize));
+        gridSizeZ = std::max(1, (int)std::ceil((maxBounds.z - minBounds.z) / gridCellSize));
+        spawnGrid.resize((size_t)gridSizeX * gridSizeZ);
+        spawnNext.reserve(capacity);
     }
 
-    void spawnEnemys()
+    // Spawns up to count enemies with at least minSpawnDistance between each other and away from the player,
+    // returns the number of enemies that found a free spot
+    int spawnEnemys(int count, glm::vec3 playerPosition)
     {
-        for (int i = 0; i < numberOfEnemies; i++)
+        count = std::min(count, capacity - (int)enemies.size());
+
+        // enter the enemies that are already alive, they moved since their spawn so a cell can hold several of them
+        std::fill(spawnGrid.begin(), spawnGrid.end(), -1);
+        spawnNext.resize(enemies.size());
+        for (size_t i = 0; i < enemies.size(); i++)
+            insert((int)i);
+
+        std::uniform_real_distribution<float> disX(minBounds.x, maxBounds.x);
+        std::uniform_real_distribution<float> disZ(minBounds.z, maxBounds.z);
+        int spawned = 0;
+        for (int attempt = 0; spawned < count && attempt < count * maxAttempts; attempt++)
         {
             // Controls that no zombies spawn directly in the player spawn area
-            std::pair<int, int> cords;
-            do
-            {
-                cords = generateUniqueRandomCoordinate(-20, 20, -20, 20);
-            } while (cords.first < 5 && cords.first > -5 || cords.second < 5 && cords.second > -5);
+            glm::vec3 candidate(disX(random), 0.0f, disZ(random));
+            glm::vec3 toPlayer = glm::vec3(playerPosition.x, 0.0f, playerPosition.z) - candidate;
+            if (glm::dot(toPlayer, toPlayer) < playerSafeDistance * playerSafeDistance || !isFree(candidate))
+                continue;
 
-            Enemy newEnemy = Enemy({cords.first, 0, cords.second}, {0, 0, 0}, {1, 1, 1}, "models/zombie/Enemy Zombie.obj", 100.f);
-            newEnemy.ID = spawnedEnemies;
-            enemies.insert(enemies.end(), newEnemy);
-            spawnedEnemies++;
+            Enemy &newEnemy = enemies.emplace_back(candidate, glm::vec3(0.0f), glm::vec3(1.0f), 100.f);
+            newEnemy.ID = nextID++;
+            spawnNext.push_back(-1);
+            insert((int)enemies.size() - 1);
+            spawned++;
         }
+        return spawned;
     }
 
-    void deleteEnemies(int id, std::list<Enemy> &listToDeleteFrom)
+    // Removes the enemy by moving the last one into its slot (keeps the pool packed, no deallocation)
+    void deleteEnemies(int id, std::vector<Enemy> &listToDeleteFrom)
     {
-        for (auto it = listToDeleteFrom.begin(); it != listToDeleteFrom.end();)
+        for (size_t i = 0; i < listToDeleteFrom.size(); i++)
         {
-            if (it->ID == id)
+            if (listToDeleteFrom[i].ID == id)
             {
                 std::cout << "Enemie deleted" << std::endl;
-                it = listToDeleteFrom.erase(it);
-                spawnedEnemies--;
-            }
-            else
-            {
-                ++it;
+                listToDeleteFrom[i] = listToDeleteFrom.back();
+                listToDeleteFrom.pop_back();
+                return;
             }
         }
     }
 
+    // restart the random sequence, same seed gives the same spawns
+    void set_seed(uint32_t seed)
+    {
+        random.seed(seed);
+    }
+
 private:
-    std::set<std::pair<int, int>> existingCoordinates;
+    int grid_index(glm::vec3 position) const
+    {
+        int x = std::clamp((int)std::floor((position.x - minBounds.x) / gridCellSize), 0, gridSizeX - 1);
+        int z = std::clamp((int)std::floor((position.z - minBounds.z) / gridCellSize), 0, gridSizeZ - 1);
+        return z * gridSizeX + x;
+    }
 
-    std::pair<int, int> generateUniqueRandomCoordinate(int minX, int maxX, int minY, int maxY)
+    // Prepends the enemy to the list of its cell
+    void insert(int index)
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> disX(minX, maxX);
-        std::uniform_int_distribution<> disY(minY, maxY);
+        int cell = grid_index(enemies[index].transform.position);
+        spawnNext[index] = spawnGrid[cell];
+        spawnGrid[cell] = index;
+    }
 
-        std::pair<int, int> generatedCoordinate;
-        do
+    // Rejects candidates closer than minSpawnDistance to any sample in the surrounding 5x5 cells
+    bool isFree(glm::vec3 candidate) const
+    {
+        int index = grid_index(candidate);
+        int cellX = index % gridSizeX;
+        int cellZ = index / gridSizeX;
+        for (int z = std::max(cellZ - 2, 0); z <= std::min(cellZ + 2, gridSizeZ - 1); z++)
         {
-            generatedCoordinate = std::make_pair(disX(gen), disY(gen));
-        } while (existingCoordinates.find(generatedCoordinate) != existingCoordinates.end());
-
-        return generatedCoordinate;
+            for (int x = std::max(cellX - 2, 0); x <= std::min(cellX + 2, gridSizeX - 1); x++)
+            {
+                for (int sample = spawnGrid[z * gridSizeX + x]; sample >= 0; sample = spawnNext[sample])
+                {
+                    glm::vec3 offset = enemies[sample].transform.position - candidate;
+                    offset.y = 0.0f;
+                    if (glm::dot(offset, offset) < minSpawnDistance * minSpawnDistance)
+                        return false;
+                }
+            }
+        }
+        return true;
     }
 
+    int capacity;
+    glm::vec3 minBounds;
+    glm::vec3 maxBounds;
+    std::mt19937 random; // the only source of randomness, same seed gives the same spawns
+
+    float minSpawnDistance; // the arena of 76 x 76 m holds about 1650 zombies at 1.5 m, 4000 need less than 0.9 m
+    float playerSafeDistance = 7.0f;
+    int maxAttempts = 30; // per requested enemy
+
+    float gridCellSize;
+    int gridSizeX;
+    int gridSizeZ;
+    std::vector<int> spawnGrid; // first enemy of every cell, -1 if empty
+    std::vector<int> spawnNext; // next enemy in the same cell, per enemy
+
 public:
-    std::list<Enemy> enemies;
-    int numberOfEnemies;
-    int spawnedEnemies = 0;
-};
\ No newline at end of file
+    std::vector<Enemy> enemies;
+    int nextID = 0;
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+// External libraries
+#include <glm/gtc/matrix_transform.hpp> // https://glm.g-truc.net/0.9.2/api/a00245.html
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Grid over the arena that stores for every walkable cell the direction towards a target (the player).
+// One breadth-first pass from the target cell is shared by all zombies, each of them only does an O(1) lookup.
+struct FlowField
+{
+    FlowField(glm::vec3 minBounds, glm::vec3 maxBounds, float cellSize = 1.0f)
+        : originX(minBounds.x), originZ(minBounds.z), cellSize(cellSize)
+    {
+        sizeX = std::max(1, (int)std::ceil((maxBounds.x - minBounds.x) / cellSize));
+        sizeZ = std::max(1, (int)std::ceil((maxBounds.z - minBounds.z) / cellSize));
+
+        size_t nCells = (size_t)sizeX * sizeZ;
+        blocked.assign(nCells, 0);
+        distances.assign(nCells, unreachable);
+        directions.assign(nCells, glm::vec3(0.0f));
+        frontier.reserve(nCells);
+    }
+
+    // Marks every cell overlapping the box (on the xz plane) as not walkable
+    void add_obstacle(glm::vec3 min, glm::vec3 max)
+    {
+        int x0 = std::max(0, (int)std::floor((min.x - originX) / cellSize));
+        int z0 = std::max(0, (int)std::floor((min.z - originZ) / cellSize));
+        int x1 = std::min(sizeX - 1, (int)std::floor((max.x - originX) / cellSize));
+        int z1 = std::min(sizeZ - 1, (int)std::floor((max.z - originZ) / cellSize));
+
+        for (int z = z0; z <= z1; z++)
+            for (int x = x0; x <= x1; x++)
+                blocked[z * sizeX + x] = 1;
+
+        targetCell = -1; // force a rebuild on the next update
+    }
+
+    // Rebuilds the field if the target entered another cell, returns true if it was rebuilt
+    bool update(glm::vec3 target)
+    {
+        int cell = cell_index(target);
+        if (cell == targetCell)
+            return false;
+
+        targetCell = cell;
+        rebuild();
+        return true;
+    }
+
+    // Direction towards the target on the xz plane (zero inside the target cell or if the target is unreachable)
+    glm::vec3 direction(glm::vec3 position) const
+    {
+        return directions[cell_index(position)];
+    }
+
+    // Walking direction of a chasing agent: along the field, straight towards the target once it shares its cell
+    glm::vec3 chase_direction(glm::vec3 position, glm::vec3 target) const
+    {
+        glm::vec3 flow = direction(position);
+        if (flow != glm::vec3(0.0f))
+            return flow;
+        glm::vec3 toTarget = glm::vec3(target.x - position.x, 0.0f, target.z - position.z);
+        float length = glm::length(toTarget);
+        return length > 1e-4f ? toTarget / length : glm::vec3(0.0f);
+    }
+
+    // Walks the cells between both points on the xz plane, false if any of them is an obstacle
+    bool line_of_sight(glm::vec3 from, glm::vec3 to) const
+    {
+        int x = cell_index(from) % sizeX;
+        int z = cell_index(from) / sizeX;
+        int endCell = cell_index(to);
+        float dirX = to.x - from.x;
+        float dirZ = to.z - from.z;
+        int stepX = dirX < 0.0f ? -1 : 1;
+        int stepZ = dirZ < 0.0f ? -1 : 1;
+
+        // distance along the ray to the next cell border and between two borders (Amanatides & Woo)
+        float invX = dirX != 0.0f ? std::abs(1.0f / dirX) : INFINITY;
+        float invZ = dirZ != 0.0f ? std::abs(1.0f / dirZ) : INFINITY;
+        float borderX = originX + (x + (stepX > 0 ? 1 : 0)) * cellSize;
+        float borderZ = originZ + (z + (stepZ > 0 ? 1 : 0)) * cellSize;
+        float tMaxX = dirX != 0.0f ? std::abs(borderX - from.x) * invX : INFINITY;
+        float tMaxZ = dirZ != 0.0f ? std::abs(borderZ - from.z) * invZ : INFINITY;
+        float tDeltaX = cellSize * invX;
+        float tDeltaZ = cellSize * invZ;
+
+        while (z * sizeX + x != endCell)
+        {
+            if (tMaxX < tMaxZ)
+            {
+                x += stepX;
+                tMaxX += tDeltaX;
+            }
+            else
+            {
+                z += stepZ;
+                tMaxZ += tDeltaZ;
+            }
+            if (x < 0 || z < 0 || x >= sizeX || z >= sizeZ)
+                return true; // left the grid, nothing in the way inside of it
+            if (blocked[z * sizeX + x])
+                return false;
+        }
+        return true;
+    }
+
+    size_t count_blocked() const
+    {
+        return (size_t)std::count(blocked.begin(), blocked.end(), (uint8_t)1);
+    }
+
+    int get_size_x() const { return sizeX; }
+    int get_size_z() const { return sizeZ; }
+
+private:
+    static constexpr uint32_t unreachable = UINT32_MAX;
+
+    // Positions outside of the grid are clamped to the border cells
+    int cell_index(glm::vec3 position) const
+    {
+        int x = std::clamp((int)std::floor((position.x - originX) / cellSize), 0, sizeX - 1);
+        int z = std::clamp((int)std::floor((position.z - originZ) / cellSize), 0, sizeZ - 1);
+        return z * sizeX + x;
+    }
+
+    bool walkable(int x, int z) const
+    {
+        return x >= 0 && z >= 0 && x < sizeX && z < sizeZ && !blocked[z * sizeX + x];
+    }
+
+    void rebuild()
+    {
+        std::fill(distances.begin(), distances.end(), unreachable);
+        std::fill(directions.begin(), directions.end(), glm::vec3(0.0f));
+        if (blocked[targetCell])
+            return;
+
+        // integration field: number of steps from every cell to the target
+        frontier.clear();
+        frontier.push_back(targetCell);
+        distances[targetCell] = 0;
+        for (size_t i = 0; i < frontier.size(); i++)
+        {
+            int cell = frontier[i];
+            int x = cell % sizeX;
+            int z = cell / sizeX;
+            uint32_t next = distances[cell] + 1;
+
+            const int offsets[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+            for (auto &offset : offsets)
+            {
+                int nx = x + offset[0];
+                int nz = z + offset[1];
+                if (!walkable(nx, nz) || distances[nz * sizeX + nx] != unreachable)
+                    continue;
+                distances[nz * sizeX + nx] = next;
+                frontier.push_back(nz * sizeX + nx);
+            }
+        }
+
+        // flow directions: point every reached cell at its closest neighbour (diagonals only if no corner is cut)
+        for (int cell : frontier)
+        {
+            if (cell == targetCell)
+                continue;
+
+            int x = cell % sizeX;
+            int z = cell / sizeX;
+            uint32_t best = distances[cell];
+            int bestX = 0, bestZ = 0;
+            for (int dz = -1; dz <= 1; dz++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    if ((dx == 0 && dz == 0) || !walkable(x + dx, z + dz))
+                        continue;
+                    if (dx != 0 && dz != 0 && (!walkable(x + dx, z) || !walkable(x, z + dz)))
+                        continue;
+
+                    uint32_t distance = distances[(z + dz) * sizeX + x + dx];
+                    if (distance < best)
+                    {
+                        best = distance;
+                        bestX = dx;
+                        bestZ = dz;
+                    }
+                }
+            }
+            directions[cell] = glm::normalize(glm::vec3((float)bestX, 0.0f, (float)bestZ));
+        }
+    }
+
+    float originX;
+    float originZ;
+    float cellSize;
+    int sizeX;
+    int sizeZ;
+    int targetCell = -1;
+
+    std::vector<uint8_t> blocked;
+    std::vector<uint32_t> distances;
+    std::vector<glm::vec3> directions;
+    std::vector<int> frontier; // doubles as the list of reached cells after the search
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+// External libraries
+#include <glm/gtc/matrix_transform.hpp> // https://glm.g-truc.net/0.9.2/api/a00245.html
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Checks for the whole horde at once whether the zombies see the player.
+// Positions and facing vectors are packed arrays, the view cone and distance tests use precomputed squared
+// thresholds (no trigonometry, no square roots) so the loop vectorizes. The optional occlusion raycasts are
+// the expensive part: zombies far away from the player only repeat them every few ticks.
+struct Vision
+{
+    // fieldOfView in degrees, up to 180
+    Vision(float fieldOfView, float sightDistance)
+    {
+        set_view(fieldOfView, sightDistance);
+    }
+
+    void set_view(float fieldOfView, float sightDistance)
+    {
+        float cosHalfFov = std::cos(glm::radians(std::min(fieldOfView, 180.0f) * 0.5f));
+        cosHalfFov2 = cosHalfFov * cosHalfFov;
+        sightDistance2 = sightDistance * sightDistance;
+    }
+
+    // Sets the number of agents, ids, positions and facing vectors have to be written before calling update()
+    void resize(size_t nAgents)
+    {
+        ids.resize(nAgents, -1);
+        lastIds.resize(nAgents, -1);
+        posX.resize(nAgents);
+        posZ.resize(nAgents);
+        forwardX.resize(nAgents);
+        forwardZ.resize(nAgents);
+        inCone.resize(nAgents);
+        visible.resize(nAgents, 0);
+    }
+
+    size_t size() const { return posX.size(); }
+
+    // Evaluates all agents, isOccluded(from, to) is only called for agents that have the player in their view cone
+    template<typename Occlusion>
+    void update(glm::vec3 player, uint32_t tick, Occlusion isOccluded)
+    {
+        size_t nAgents = size();
+        float px = player.x;
+        float pz = player.z;
+
+        // view cone + distance for the whole horde in one branchless loop
+        for (size_t i = 0; i < nAgents; i++)
+        {
+            float dx = px - posX[i];
+            float dz = pz - posZ[i];
+            float distance2 = dx * dx + dz * dz;
+            float dot = dx * forwardX[i] + dz * forwardZ[i];
+            inCone[i] = (distance2 < sightDistance2) & (dot > 0.0f) & (dot * dot > cosHalfFov2 * distance2);
+        }
+
+        // occlusion, time-sliced for far away agents (they keep their last result in between).
+        // A slot that got another agent (swap-remove of a dead one) must not inherit its result, it checks right away.
+        for (size_t i = 0; i < nAgents; i++)
+        {
+            bool bNewAgent = ids[i] != lastIds[i];
+            lastIds[i] = ids[i];
+            if (!inCone[i])
+            {
+                visible[i] = 0;
+                continue;
+            }
+
+            float dx = px - posX[i];
+            float dz = pz - posZ[i];
+            bool bNear = dx * dx + dz * dz < nearDistance * nearDistance;
+            if (bNear || bNewAgent || (i + tick) % farInterval == 0)
+                visible[i] = !isOccluded(glm::vec3(posX[i], 0.0f, posZ[i]), player);
+        }
+    }
+
+    // Same without occlusion
+    void update(glm::vec3 player, uint32_t tick)
+    {
+        update(player, tick, [](glm::vec3, glm::vec3) { return false; });
+    }
+
+    // packed agent state
+    std::vector<int> ids; // identifies the agent in a slot
+    std::vector<float> posX;
+    std::vector<float> posZ;
+    std::vector<float> forwardX; // unit facing vector on the xz plane
+    std::vector<float> forwardZ;
+    std::vector<uint8_t> visible;
+
+    float nearDistance = 15.0f; // agents closer than this check occlusion every tick
+    uint32_t farInterval = 4; // the others every n-th tick
+
+private:
+    std::vector<uint8_t> inCone;
+    std::vector<int> lastIds; // agent of the slot during the last update
+    float cosHalfFov2;
+    float sightDistance2;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include "enemy_system/enemy_system.hpp"
+
+#include <cmath>
+
+// Sends escalating waves of zombies: the next wave starts when the timer ran out or all zombies are dead
+struct WaveDirector
+{
+    WaveDirector(int firstWaveSize, float growth, float waveInterval)
+        : firstWaveSize(firstWaveSize), growth(growth), waveInterval(waveInterval) {}
+
+    void update(float delta, EnemySystem &enemySystem, glm::vec3 playerPosition)
+    {
+        timeUntilNextWave -= delta;
+        if (timeUntilNextWave > 0.0f && !enemySystem.enemies.empty())
+            return;
+
+        wave++;
+        int waveSize = (int)std::round(firstWaveSize * std::pow(growth, (float)(wave - 1)));
+        int spawned = enemySystem.spawnEnemys(waveSize, playerPosition);
+        std::cout << "Wave " << wave << ": " << spawned << " zombies" << std::endl;
+        timeUntilNextWave = waveInterval;
+    }
+
+    int wave = 0;
+
+private:
+    int firstWaveSize;
+    float growth;
+    float waveInterval; // seconds
+    float timeUntilNextWave = 0.0f;
+};
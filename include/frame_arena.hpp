@@ -0,0 +1,25 @@
+#pragma once
+#include <memory_resource>
+#include <memory>
+#include <cstddef>
+
+// Linear (bump) allocator for data that only lives for one frame/tick, reset() frees everything at once.
+// Containers use it through std::pmr, e.g. std::pmr::vector<int> list(arena.get());
+// if the buffer runs out it falls back to the regular heap until the next reset.
+struct FrameArena {
+    FrameArena(size_t nBytes)
+        : buffer(std::make_unique<std::byte[]>(nBytes)),
+          resource(buffer.get(), nBytes, std::pmr::new_delete_resource()) {}
+
+    void reset() {
+        resource.release(); // next allocation starts at the beginning of the buffer again
+    }
+
+    std::pmr::memory_resource* get() {
+        return &resource;
+    }
+
+private:
+    std::unique_ptr<std::byte[]> buffer;
+    std::pmr::monotonic_buffer_resource resource;
+};
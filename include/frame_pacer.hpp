@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+//
+#include "timer.hpp"
+
+// Sleeps most of the way and spins the rest, OS sleeps often overshoot by a millisecond or more
+inline void precise_sleep_until(Timer::clock::time_point deadline, Timer::clock::duration spinThreshold = std::chrono::microseconds(1500)) {
+    if (deadline - Timer::clock::now() > spinThreshold)
+        std::this_thread::sleep_until(deadline - spinThreshold);
+    while (Timer::clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+// Percentiles of the recorded frame times in milliseconds
+struct FrameTimeStats {
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+};
+
+// Rolling history of the last frame times
+struct FrameTimeHistory {
+    void push(float milliseconds) {
+        samples[next] = milliseconds;
+        next = (next + 1) % samples.size();
+        count = std::min(count + 1, samples.size());
+    }
+
+    FrameTimeStats stats() {
+        FrameTimeStats result;
+        if (count == 0) return result;
+
+        std::copy_n(samples.begin(), count, sorted.begin());
+        auto percentile = [&](float p) {
+            auto nth = sorted.begin() + std::min(count - 1, (size_t)(p * count));
+            std::nth_element(sorted.begin(), nth, sorted.begin() + count);
+            return *nth;
+        };
+        result.p50 = percentile(0.50f);
+        result.p95 = percentile(0.95f);
+        result.p99 = percentile(0.99f);
+        result.max = *std::max_element(samples.begin(), samples.begin() + count);
+        return result;
+    }
+
+    void clear() {
+        next = 0;
+        count = 0;
+    }
+
+    size_t size() {
+        return count;
+    }
+
+private:
+    std::array<float, 512> samples = {};
+    std::array<float, 512> sorted = {};
+    size_t next = 0;
+    size_t count = 0;
+};
+
+// Limits the frame rate to a target frame time and records how long the frames actually took
+struct FramePacer {
+    // 0 disables the limiter (frame rate is only bound by vsync)
+    void set_target_fps(float fps) {
+        targetFps = fps;
+        deadline = Timer::clock::now();
+    }
+    float get_target_fps() {
+        return targetFps;
+    }
+
+    // call once per frame after presenting it
+    void end_frame() {
+        if (targetFps > 0.0f) {
+            auto frameTime = std::chrono::duration_cast<Timer::clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+            // schedule against the previous deadline so the rate does not drift, but never try to catch up after a hitch
+            deadline = std::max(deadline + frameTime, Timer::clock::now());
+            precise_sleep_until(deadline);
+        }
+
+        timer.update();
+        history.push((float)timer.get_delta_ms());
+    }
+
+    FrameTimeStats stats() {
+        return history.stats();
+    }
+
+    Timer timer;
+    FrameTimeHistory history;
+
+private:
+    float targetFps = 0.0f;
+    Timer::clock::time_point deadline = Timer::clock::now();
+};
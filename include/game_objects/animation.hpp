@@ -0,0 +1,211 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <assimp/scene.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANIMATION_SSE
+#endif
+
+// Joint hierarchy of a model (every node of the imported scene), ordered parent first
+struct Skeleton {
+    struct Joint {
+        std::string name;
+        int parent; // -1 for the root
+        // local bind transform
+        glm::vec3 translation;
+        glm::vec4 rotation; // quaternion as x, y, z, w
+        glm::vec3 scale;
+        glm::mat4 offset = glm::mat4(1.0f); // mesh space to joint space (inverse bind matrix)
+    };
+
+    void load(const aiNode* pRoot, unsigned int nMeshes) {
+        joints.clear();
+        meshJoints.assign(nMeshes, -1);
+        add_node(pRoot, -1);
+    }
+    int find(const char* name) const {
+        for (size_t i = 0; i < joints.size(); i++)
+            if (joints[i].name == name) return (int)i;
+        return -1;
+    }
+    size_t size() const { return joints.size(); }
+
+    std::vector<Joint> joints;
+    std::vector<int> meshJoints; // joint of the node that references each mesh
+
+private:
+    void add_node(const aiNode* pNode, int parent) {
+        aiVector3D scale, translation;
+        aiQuaternion rotation;
+        pNode->mTransformation.Decompose(scale, rotation, translation);
+        int index = (int)joints.size();
+        joints.push_back({pNode->mName.C_Str(), parent, glm::vec3(translation.x, translation.y, translation.z),
+            glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w), glm::vec3(scale.x, scale.y, scale.z)});
+        for (unsigned int i = 0; i < pNode->mNumMeshes; i++)
+            if (meshJoints[pNode->mMeshes[i]] < 0) meshJoints[pNode->mMeshes[i]] = index;
+        for (unsigned int i = 0; i < pNode->mNumChildren; i++)
+            add_node(pNode->mChildren[i], index);
+    }
+};
+
+// Local joint transforms of one instance
+struct Pose {
+    void reset(const Skeleton& skeleton) {
+        translations.resize(skeleton.size());
+        rotations.resize(skeleton.size());
+        for (size_t i = 0; i < skeleton.size(); i++) {
+            translations[i] = skeleton.joints[i].translation;
+            rotations[i] = skeleton.joints[i].rotation;
+        }
+    }
+
+    std::vector<glm::vec3> translations;
+    std::vector<glm::vec4> rotations; // x, y, z, w
+};
+
+// Normalized lerp between two quaternions along the shorter arc (x, y, z, w)
+inline glm::vec4 quat_nlerp(const glm::vec4& a, const glm::vec4& b, float t) {
+#ifdef ANIMATION_SSE
+    __m128 va = _mm_loadu_ps(&a.x);
+    __m128 vb = _mm_loadu_ps(&b.x);
+    // dot product in all lanes
+    __m128 dot = _mm_mul_ps(va, vb);
+    dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+    dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+    // flip b to the same hemisphere (xor of the sign bit)
+    vb = _mm_xor_ps(vb, _mm_and_ps(dot, _mm_set1_ps(-0.0f)));
+    __m128 result = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), _mm_set1_ps(t)));
+    __m128 length = _mm_mul_ps(result, result);
+    length = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(2, 3, 0, 1)));
+    length = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(1, 0, 3, 2)));
+    result = _mm_div_ps(result, _mm_sqrt_ps(length));
+    glm::vec4 out;
+    _mm_storeu_ps(&out.x, result);
+    return out;
+#else
+    glm::vec4 target = glm::dot(a, b) < 0.0f ? -b : b;
+    return glm::normalize(a + (target - a) * t);
+#endif
+}
+
+// Animation resampled at a fixed rate, so sampling is a direct index instead of a key search.
+// Only animated joints are stored, rotations are quantized to 16 bit per component (8 bytes per key).
+struct AnimationClip {
+    static constexpr float sampleRate = 30.0f;
+
+    void load(const aiAnimation* pAnimation, const Skeleton& skeleton) {
+        name = pAnimation->mName.C_Str();
+        double ticksPerSecond = pAnimation->mTicksPerSecond > 0.0 ? pAnimation->mTicksPerSecond : 25.0;
+        duration = (float)(pAnimation->mDuration / ticksPerSecond);
+        nFrames = std::max(2u, (uint32_t)std::ceil(duration * sampleRate) + 1);
+
+        for (unsigned int c = 0; c < pAnimation->mNumChannels; c++) {
+            int joint = skeleton.find(pAnimation->mChannels[c]->mNodeName.C_Str());
+            if (joint >= 0) joints.push_back((uint16_t)joint);
+        }
+        rotations.resize((size_t)nFrames * joints.size() * 4);
+        translations.resize((size_t)nFrames * joints.size());
+
+        size_t iJoint = 0;
+        for (unsigned int c = 0; c < pAnimation->mNumChannels; c++) {
+            const aiNodeAnim* pChannel = pAnimation->mChannels[c];
+            if (skeleton.find(pChannel->mNodeName.C_Str()) < 0) continue;
+            for (uint32_t frame = 0; frame < nFrames; frame++) {
+                double tick = std::min((double)frame / sampleRate, (double)duration) * ticksPerSecond;
+                glm::vec4 rotation = sample_rotation(pChannel, tick);
+                int16_t* key = &rotations[((size_t)frame * joints.size() + iJoint) * 4];
+                for (int k = 0; k < 4; k++)
+                    key[k] = (int16_t)std::lround(std::clamp(rotation[k], -1.0f, 1.0f) * 32767.0f);
+                translations[(size_t)frame * joints.size() + iJoint] = sample_translation(pChannel, tick);
+            }
+            iJoint++;
+        }
+    }
+
+    // writes the clip at the (looped) time into the pose, blended with what is already there by weight
+    void sample(float time, Pose& pose, float weight = 1.0f) const {
+        if (joints.empty()) return;
+        float frame = std::fmod(std::max(time, 0.0f), duration > 0.0f ? duration : 1.0f) * sampleRate;
+        uint32_t frame0 = std::min((uint32_t)frame, nFrames - 1);
+        uint32_t frame1 = std::min(frame0 + 1, nFrames - 1);
+        float alpha = frame - (float)frame0;
+        const int16_t* keys0 = &rotations[(size_t)frame0 * joints.size() * 4];
+        const int16_t* keys1 = &rotations[(size_t)frame1 * joints.size() * 4];
+        const glm::vec3* translations0 = &translations[(size_t)frame0 * joints.size()];
+        const glm::vec3* translations1 = &translations[(size_t)frame1 * joints.size()];
+
+        for (size_t i = 0; i < joints.size(); i++) {
+            glm::vec4 rotation = quat_nlerp(dequantize(keys0 + i * 4), dequantize(keys1 + i * 4), alpha);
+            glm::vec3 translation = glm::mix(translations0[i], translations1[i], alpha);
+            uint16_t joint = joints[i];
+            if (weight < 1.0f) {
+                rotation = quat_nlerp(pose.rotations[joint], rotation, weight);
+                translation = glm::mix(pose.translations[joint], translation, weight);
+            }
+            pose.rotations[joint] = rotation;
+            pose.translations[joint] = translation;
+        }
+    }
+
+    std::string name;
+    float duration = 0.0f; // seconds
+    uint32_t nFrames = 0;
+
+private:
+    static glm::vec4 dequantize(const int16_t* key) {
+#ifdef ANIMATION_SSE
+        __m128i packed = _mm_loadl_epi64((const __m128i*)key);
+        __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16); // sign extend to 32 bit
+        glm::vec4 out;
+        _mm_storeu_ps(&out.x, _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(1.0f / 32767.0f)));
+        return out;
+#else
+        return glm::vec4(key[0], key[1], key[2], key[3]) * (1.0f / 32767.0f);
+#endif
+    }
+    static glm::vec4 sample_rotation(const aiNodeAnim* pChannel, double tick) {
+        unsigned int i = 0;
+        while (i + 1 < pChannel->mNumRotationKeys && pChannel->mRotationKeys[i + 1].mTime <= tick) i++;
+        const aiQuaternion& a = pChannel->mRotationKeys[i].mValue;
+        if (i + 1 >= pChannel->mNumRotationKeys)
+            return glm::vec4(a.x, a.y, a.z, a.w);
+        const aiQuatKey& next = pChannel->mRotationKeys[i + 1];
+        float t = (float)((tick - pChannel->mRotationKeys[i].mTime) / (next.mTime - pChannel->mRotationKeys[i].mTime));
+        return quat_nlerp(glm::vec4(a.x, a.y, a.z, a.w), glm::vec4(next.mValue.x, next.mValue.y, next.mValue.z, next.mValue.w), t);
+    }
+    static glm::vec3 sample_translation(const aiNodeAnim* pChannel, double tick) {
+        unsigned int i = 0;
+        while (i + 1 < pChannel->mNumPositionKeys && pChannel->mPositionKeys[i + 1].mTime <= tick) i++;
+        const aiVector3D& a = pChannel->mPositionKeys[i].mValue;
+        if (i + 1 >= pChannel->mNumPositionKeys)
+            return glm::vec3(a.x, a.y, a.z);
+        const aiVectorKey& next = pChannel->mPositionKeys[i + 1];
+        float t = (float)((tick - pChannel->mPositionKeys[i].mTime) / (next.mTime - pChannel->mPositionKeys[i].mTime));
+        return glm::mix(glm::vec3(a.x, a.y, a.z), glm::vec3(next.mValue.x, next.mValue.y, next.mValue.z), t);
+    }
+
+    std::vector<uint16_t> joints;         // animated joints
+    std::vector<int16_t> rotations;       // nFrames x joints x 4
+    std::vector<glm::vec3> translations;  // nFrames x joints
+};
+
+// Skinning matrices of a pose (joint global transform * inverse bind), globals is scratch space
+inline void compute_palette(const Skeleton& skeleton, const Pose& pose, glm::mat4* palette, std::vector<glm::mat4>& globals) {
+    globals.resize(skeleton.size());
+    for (size_t i = 0; i < skeleton.size(); i++) {
+        const Skeleton::Joint& joint = skeleton.joints[i];
+        const glm::vec4& q = pose.rotations[i];
+        glm::mat4 local = glm::translate(glm::mat4(1.0f), pose.translations[i]) * glm::mat4_cast(glm::quat(q.w, q.x, q.y, q.z));
+        local = glm::scale(local, joint.scale);
+        globals[i] = joint.parent >= 0 ? globals[joint.parent] * local : local; // parents come first
+        palette[i] = globals[i] * joint.offset;
+    }
+}
@@ -17,12 +17,14 @@ struct Camera
     {
         float fov = glm::radians(70.0f);
         projectionMatrix = glm::perspectiveFov(fov, width, height, nearPlane, farPlane);
+        update_view();
     }
     // constructor for orthographic camera
     Camera(glm::vec3 position, glm::vec3 rotation)
         : position(position), rotation(glm::radians(rotation))
     {
         projectionMatrix = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, nearPlane, farPlane);
+        update_view();
     }
 
     // translate relative to camera direction
@@ -31,13 +33,18 @@ struct Camera
         // position.y = 1.0f;
     }
 
-    void bind()
+    // recalculate the view matrix from position and rotation (no GL calls, safe on any thread)
+    void update_view()
     {
-        //glm::mat4x4 viewMatrix(1.0f);
         viewMatrix = glm::mat4x4(1.0f);
         viewMatrix = glm::rotate(viewMatrix, -rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
         viewMatrix = glm::rotate(viewMatrix, -rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
         viewMatrix = glm::translate(viewMatrix, -position);
+    }
+
+    void bind()
+    {
+        update_view();
 
         glUniformMatrix4fv(4, 1, false, glm::value_ptr(viewMatrix));
         glUniformMatrix4fv(8, 1, false, glm::value_ptr(projectionMatrix));
@@ -70,6 +77,22 @@ struct Camera
         return cameraToWorldMatrix;
     }
 
+    // planes of the view frustum (Gribb/Hartmann) as xyz = normal pointing inside, w = distance
+    void frustum_planes(glm::vec4 planes[6]) const
+    {
+        glm::mat4x4 viewProjection = projectionMatrix * viewMatrix;
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++)
+            rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        for (int i = 0; i < 3; i++)
+        {
+            planes[i * 2 + 0] = rows[3] + rows[i];
+            planes[i * 2 + 1] = rows[3] - rows[i];
+        }
+        for (int i = 0; i < 6; i++)
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+
     glm::mat4x4 viewMatrix;
     glm::mat4x4 projectionMatrix;
     glm::vec3 position;
@@ -1,4 +1,5 @@
 #pragma once
+#include "render_stats.hpp"
 
 struct Material {
     void bind() {
@@ -14,6 +15,7 @@ struct Material {
         if (diffuseBlend > 0.0f) {
             glBindTextureUnit(0, diffuseTexture);
         }
+        RenderStats::get().counters().materialBinds++;
     }
 
     glm::vec3 ambient = glm::vec3(0.1f); // first slot
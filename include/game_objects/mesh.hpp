@@ -1,6 +1,7 @@
 #pragma once
 #include "transform.hpp"
 #include "material.hpp"
+#include "render_stats.hpp"
 #include <stdio.h>
 
 struct Vertex {
@@ -10,6 +11,17 @@ struct Vertex {
     glm::vec4 col = glm::vec4(0.0f);
 };
 
+// joints and weights of a skinned vertex (second vertex buffer, only for models loaded with a skeleton)
+struct SkinWeights {
+    glm::uvec4 joints = glm::uvec4(0);
+    glm::vec4 weights = glm::vec4(0.0f);
+};
+// blended joint matrix of a vertex, the CPU side of the SKINNING shaders
+inline glm::mat4 skin_matrix(const SkinWeights& skin, const glm::mat4* palette) {
+    return palette[skin.joints.x] * skin.weights.x + palette[skin.joints.y] * skin.weights.y
+         + palette[skin.joints.z] * skin.weights.z + palette[skin.joints.w] * skin.weights.w;
+}
+
 struct Mesh {
     Mesh() {
         glCreateVertexArrays(1, &vao); // vertex array object
@@ -20,8 +32,30 @@ struct Mesh {
         load_mesh(pMesh);
     }
     ~Mesh() {
-        std::vector<GLuint> buffers = { vao, vbo, ebo };
-        glDeleteBuffers(buffers.size(), buffers.data());
+        if (vao == 0) return; // moved from
+        GLuint buffers[] = { vbo, ebo, skinVbo };
+        glDeleteBuffers(skinVbo ? 3 : 2, buffers);
+        glDeleteVertexArrays(1, &vao);
+    }
+    // owns its GL objects: moved, never copied
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    Mesh(Mesh&& other) noexcept
+        : materialIndex(other.materialIndex), vao(other.vao), vbo(other.vbo), ebo(other.ebo), skinVbo(other.skinVbo),
+          vertices(std::move(other.vertices)), indices(std::move(other.indices)), skin(std::move(other.skin)) {
+        other.vao = other.vbo = other.ebo = other.skinVbo = 0;
+    }
+    Mesh& operator=(Mesh&& other) noexcept {
+        // the other one deletes our old objects
+        std::swap(materialIndex, other.materialIndex);
+        std::swap(vao, other.vao);
+        std::swap(vbo, other.vbo);
+        std::swap(ebo, other.ebo);
+        std::swap(skinVbo, other.skinVbo);
+        std::swap(vertices, other.vertices);
+        std::swap(indices, other.indices);
+        std::swap(skin, other.skin);
+        return *this;
     }
 
     void load_sphere(float nSectors, float nStacks, bool bInvertNormals = false) {
@@ -174,10 +208,42 @@ struct Mesh {
         describe_layout();
     }
 
+    // adds joints and weights as attributes 4 and 5 (after load_mesh)
+    void load_skin(const std::vector<SkinWeights>& skin) {
+        this->skin = skin; // kept for baking vertex animations
+        glCreateBuffers(1, &skinVbo);
+        glNamedBufferStorage(skinVbo, skin.size() * sizeof(SkinWeights), skin.data(), BufferStorageMask::GL_NONE_BIT);
+        GLuint binding = 1;
+        glVertexArrayVertexBuffer(vao, binding, skinVbo, 0, sizeof(SkinWeights));
+        GLuint i;
+        i = 4; // joint indices
+        glVertexArrayAttribIFormat(vao, i, 4, GL_UNSIGNED_INT, 0);
+        glVertexArrayAttribBinding(vao, i, binding);
+        glEnableVertexArrayAttrib(vao, i);
+        i = 5; // joint weights
+        glVertexArrayAttribFormat(vao, i, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLuint));
+        glVertexArrayAttribBinding(vao, i, binding);
+        glEnableVertexArrayAttrib(vao, i);
+    }
+
     void draw() {
         glBindVertexArray(vao);
         glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
+        RenderStats::Counters& counters = RenderStats::get().counters();
+        counters.drawCalls++;
+        counters.triangles += indices.size() / 3;
     }
+    // per instance data comes from the bound buffers (gl_BaseInstance + gl_InstanceID)
+    void draw_instanced(GLsizei nInstances, GLuint firstInstance = 0) {
+        glBindVertexArray(vao);
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr, nInstances, firstInstance);
+        RenderStats::Counters& counters = RenderStats::get().counters();
+        counters.drawCalls++;
+        counters.triangles += indices.size() / 3 * nInstances;
+    }
+
+    const std::vector<Vertex>& get_vertices() const { return vertices; }
+    const std::vector<SkinWeights>& get_skin() const { return skin; }
 
 private:
     void describe_layout() {
@@ -224,6 +290,8 @@ private:
     GLuint vao; // vertex array object
     GLuint vbo; // vertex buffer object
     GLuint ebo; // element buffer object
+    GLuint skinVbo = 0; // joints and weights (skinned meshes only)
     std::vector<Vertex> vertices;
     std::vector<GLuint> indices;
+    std::vector<SkinWeights> skin;
 };
\ No newline at end of file
@@ -8,11 +8,14 @@
 #include "utils.hpp"
 #include "mesh.hpp"
 #include "material.hpp"
+#include "animation.hpp"
+#include "vertex_animation.hpp"
 #include "cmrc_io.hpp"
 
 // https://github.com/jimmiebergmann/Sponza
 struct Model {
-    Model(glm::vec3 pos, glm::vec3 rot, glm::vec3 scale, std::string path)
+    // bSkeleton keeps the node hierarchy, bones and animations (drawn with draw_instanced and a SKINNING pipeline)
+    Model(glm::vec3 pos, glm::vec3 rot, glm::vec3 scale, std::string path, bool bSkeleton = false)
     : transform(pos, rot, scale) {
         Assimp::Importer importer;
 
@@ -21,7 +24,8 @@ struct Model {
         flags |= aiProcess_Triangulate; // triangulate all faces if not already triangulated
         flags |= aiProcess_GenNormals; // generate normals if they dont exist
         flags |= aiProcess_FlipUVs; // OpenGL prefers flipped y axis
-        flags |= aiProcess_PreTransformVertices; // simplifies model load
+        if (bSkeleton) flags |= aiProcess_LimitBoneWeights; // at most 4 joints per vertex
+        else flags |= aiProcess_PreTransformVertices; // simplifies model load
         
         // load model
         #ifdef EMBEDDED_MODELS
@@ -40,11 +44,27 @@ struct Model {
         size_t sepIndex = path.find_last_of('/');
         modelRoot = path.substr(0, sepIndex + 1);
 
+        // every node becomes a joint, meshes without bones are rigidly attached to their node
+        if (bSkeleton) skeleton.load(pScene->mRootNode, pScene->mNumMeshes);
+
         // create meshes
         meshes.reserve(pScene->mNumMeshes);
         for (int i = 0; i < pScene->mNumMeshes; i++) {
             aiMesh* pMesh = pScene->mMeshes[i];
             meshes.emplace_back(pMesh);
+            if (bSkeleton) meshes.back().load_skin(load_skin(pMesh, skeleton.meshJoints[i]));
+        }
+
+        // animations are resampled into compact clips, idle and walk are also baked for crowds
+        if (bSkeleton) {
+            clips.resize(pScene->mNumAnimations);
+            for (int i = 0; i < pScene->mNumAnimations; i++)
+                clips[i].load(pScene->mAnimations[i], skeleton);
+            idleClip = find_clip("idle");
+            if (idleClip < 0) idleClip = clips.empty() ? -1 : 0;
+            walkClip = find_clip("walk");
+            if (walkClip < 0) walkClip = idleClip;
+            vertexAnimation.bake(meshes, skeleton, clips, {idleClip, walkClip});
         }
 
         // create textures (if embedded into model, such as .glb)
@@ -87,7 +107,11 @@ struct Model {
 
     }
     void draw() {
-        transform.bind();
+        draw(transform);
+    }
+    // draw the model's meshes at the given instance transform instead of its own
+    void draw(const Transform& instance) {
+        instance.bind();
         for (int i = 0; i < meshes.size(); i++) {
             Material& material = materials[meshes[i].materialIndex];
             material.bind();
@@ -95,7 +119,57 @@ struct Model {
         }
     }
 
+    // draws instances of the bound instance/palette buffers (skinned models)
+    void draw_instanced(GLsizei nInstances, GLuint firstInstance = 0) {
+        if (vertexAnimation.is_baked()) vertexAnimation.bind();
+        for (int i = 0; i < meshes.size(); i++) {
+            Material& material = materials[meshes[i].materialIndex];
+            material.bind();
+            vertexAnimation.bind_mesh(i);
+            meshes[i].draw_instanced(nInstances, firstInstance);
+        }
+    }
+
+    const std::vector<Mesh>& get_meshes() const { return meshes; }
+
+    // index of the first clip whose name contains the text, -1 if there is none
+    int find_clip(const char* text) const {
+        for (size_t i = 0; i < clips.size(); i++)
+            if (clips[i].name.find(text) != std::string::npos) return (int)i;
+        return -1;
+    }
+
 private:
+    std::vector<SkinWeights> load_skin(aiMesh* pMesh, int meshJoint) {
+        std::vector<SkinWeights> skin(pMesh->mNumVertices);
+        if (!pMesh->HasBones()) {
+            for (SkinWeights& vertex : skin)
+                vertex = {glm::uvec4(std::max(meshJoint, 0), 0, 0, 0), glm::vec4(1.0f, 0.0f, 0.0f, 0.0f)};
+            return skin;
+        }
+        std::vector<uint8_t> nInfluences(pMesh->mNumVertices, 0);
+        for (unsigned int b = 0; b < pMesh->mNumBones; b++) {
+            const aiBone* pBone = pMesh->mBones[b];
+            int joint = skeleton.find(pBone->mName.C_Str());
+            if (joint < 0) continue;
+            skeleton.joints[joint].offset = glm::transpose(glm::make_mat4(&pBone->mOffsetMatrix.a1)); // assimp is row major
+            for (unsigned int w = 0; w < pBone->mNumWeights; w++) {
+                const aiVertexWeight& weight = pBone->mWeights[w];
+                uint8_t& slot = nInfluences[weight.mVertexId];
+                if (slot >= 4) continue;
+                skin[weight.mVertexId].joints[slot] = (uint32_t)joint;
+                skin[weight.mVertexId].weights[slot] = weight.mWeight;
+                slot++;
+            }
+        }
+        for (SkinWeights& vertex : skin) {
+            float sum = vertex.weights.x + vertex.weights.y + vertex.weights.z + vertex.weights.w;
+            if (sum > 0.0f) vertex.weights /= sum;
+            else vertex.weights = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+        }
+        return skin;
+    }
+
     GLuint get_texture(aiMaterial* pMaterial, aiTextureType texType) {
         // build path to texture resource
         aiString aiTexPath;
@@ -173,4 +247,9 @@ private:
     std::string modelRoot;
 public:
     Transform transform;
+    Skeleton skeleton; // only with bSkeleton
+    std::vector<AnimationClip> clips;
+    int idleClip = -1; // -1 without clips
+    int walkClip = -1; // idle if there is no walk clip
+    VertexAnimation vertexAnimation; // baked idle (clip 0) and walk (clip 1)
 };
\ No newline at end of file
@@ -15,8 +15,8 @@
 
 // Manages the player's life
 struct Player {
-    Player(glm::vec3 position, glm::vec3 rotation, float health, float stamina, float movementSpeed, float sprintSpeed, float rotationSpeed)
-    : position(position), rotation(glm::radians(rotation)), health(health), stamina(stamina), movementSpeed(movementSpeed), sprintSpeed(sprintSpeed), rotationSpeed(rotationSpeed) {}
+    Player(glm::vec3 position, glm::vec3 rotation, float health, float stamina, float movementSpeed, float sprintSpeed, float rotationSpeed, int arenaSize = 40)
+    : position(position), rotation(glm::radians(rotation)), health(health), stamina(stamina), movementSpeed(movementSpeed), sprintSpeed(sprintSpeed), rotationSpeed(rotationSpeed), map(arenaSize, arenaSize) {}
 
     // Enables movement only in the horizontal plane without flying
     void move(float x, float y, float z) {
@@ -71,6 +71,6 @@ public:
     glm::vec3 position;
     glm::vec3 rotation; // euler rotation
     
-    // Create the limited map
-    Terrain map = Terrain(40,40);
+    // The limited map, arenaSize meters from the middle to each side
+    Terrain map;
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <assimp/material.h>
 #include "utils.hpp"
 #include "cmrc_io.hpp"
+#include "render_stats.hpp"
 
 #include<filesystem>
 namespace fs = std::filesystem;
@@ -81,6 +82,8 @@ struct Skybox {
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
 		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+		RenderStats::get().counters().drawCalls++;
+		RenderStats::get().counters().triangles += 12;
 		glBindVertexArray(0);
 
 		// Switch back to the normal depth function
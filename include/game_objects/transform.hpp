@@ -3,6 +3,8 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/matrix_transform.hpp> // https://glm.g-truc.net/0.9.2/api/a00245.html
 #include <glm/gtx/euler_angles.hpp> // https://glm.g-truc.net/0.9.1/api/a00251.html
+//
+#include "render_stats.hpp"
 #include <glm/gtc/type_ptr.hpp> // allows use of glm::value_ptr to get raw pointer to data
 
 struct Transform {
@@ -13,13 +15,18 @@ struct Transform {
         : position(pos), rotation(rot), scale(scale) {
         }
 
-    void bind() {
+    glm::mat4x4 matrix() const {
         glm::mat4x4 modelMatrix(1.0f); // set matrix to identity
 
         // calculate model matrix
         modelMatrix = glm::translate(modelMatrix, position);
         modelMatrix *= glm::yawPitchRoll(rotation.x, rotation.y, rotation.z);
         modelMatrix = glm::scale(modelMatrix, scale);
+        return modelMatrix;
+    }
+
+    void bind() const {
+        glm::mat4x4 modelMatrix = matrix();
 
         // calculate normal matrix (only need rotation)
         glm::mat3x3 normalMatrix(1.0f);
@@ -27,6 +34,7 @@ struct Transform {
 
         glUniformMatrix4fv(0, 1, false, glm::value_ptr(modelMatrix));
         glUniformMatrix3fv(12, 1, false, glm::value_ptr(normalMatrix));
+        RenderStats::get().counters().transformBinds++;
     }
 
     glm::vec3 position;
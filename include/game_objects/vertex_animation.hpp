@@ -0,0 +1,135 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <glm/glm.hpp>
+//
+#include "mesh.hpp"
+#include "animation.hpp"
+
+// Vertex animation texture (VAT): the skinned vertices of a few clips, baked once per frame into textures.
+// Texel x = vertex % width, y = frame * rowsPerFrame + vertex / width, all meshes of the model one after another.
+// Crowd instances play it in the SKINNING shaders with two texel fetches instead of a palette, so they need no pose on the CPU.
+struct VertexAnimation {
+    static constexpr float sampleRate = 15.0f; // frames per second, the shader interpolates between them
+    static constexpr uint32_t width = 1024;    // vertices per texture row
+    struct Clip {
+        uint32_t firstFrame;
+        uint32_t nFrames;
+    };
+
+    ~VertexAnimation() {
+        if (positionTexture) {
+            GLuint textures[] = { positionTexture, normalTexture };
+            glDeleteTextures(2, textures);
+        }
+    }
+    VertexAnimation() = default;
+    // owns its textures: moved, never copied
+    VertexAnimation(const VertexAnimation&) = delete;
+    VertexAnimation& operator=(const VertexAnimation&) = delete;
+    VertexAnimation(VertexAnimation&& other) noexcept
+        : clips(std::move(other.clips)), vertexOffsets(std::move(other.vertexOffsets)), rowsPerFrame(other.rowsPerFrame),
+          positionTexture(other.positionTexture), normalTexture(other.normalTexture) {
+        other.positionTexture = other.normalTexture = 0;
+    }
+    VertexAnimation& operator=(VertexAnimation&& other) noexcept {
+        // the other one deletes our old textures
+        std::swap(clips, other.clips);
+        std::swap(vertexOffsets, other.vertexOffsets);
+        std::swap(rowsPerFrame, other.rowsPerFrame);
+        std::swap(positionTexture, other.positionTexture);
+        std::swap(normalTexture, other.normalTexture);
+        return *this;
+    }
+
+    // bakes the clips in the given order (-1 bakes a single frame of the bind pose)
+    void bake(const std::vector<Mesh>& meshes, const Skeleton& skeleton, const std::vector<AnimationClip>& animationClips, const std::vector<int>& clipIndices) {
+        uint32_t nVertices = 0;
+        vertexOffsets.clear();
+        for (const Mesh& mesh : meshes) {
+            vertexOffsets.push_back(nVertices);
+            nVertices += (uint32_t)mesh.get_vertices().size();
+        }
+        rowsPerFrame = std::max(1u, (nVertices + width - 1) / width);
+
+        uint32_t nFrames = 0;
+        clips.clear();
+        for (int clip : clipIndices) {
+            uint32_t nClipFrames = clip >= 0 ? std::max(1u, (uint32_t)std::ceil(animationClips[clip].duration * sampleRate)) : 1;
+            clips.push_back({nFrames, nClipFrames});
+            nFrames += nClipFrames;
+        }
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        if (nFrames * rowsPerFrame > (uint32_t)maxSize) {
+            std::cerr << "vertex animation needs " << nFrames * rowsPerFrame << " texture rows, not baked" << std::endl;
+            clips.clear();
+            return;
+        }
+
+        // evaluate every frame on the CPU, the same math as the skinning shader
+        size_t frameSize = (size_t)width * rowsPerFrame;
+        std::vector<glm::vec4> positions(frameSize * nFrames, glm::vec4(0.0f));
+        std::vector<glm::vec4> normals(frameSize * nFrames, glm::vec4(0.0f));
+        Pose pose;
+        std::vector<glm::mat4> globals;
+        std::vector<glm::mat4> palette(std::max<size_t>(skeleton.size(), 1), glm::mat4(1.0f));
+        for (size_t c = 0; c < clipIndices.size(); c++) {
+            for (uint32_t frame = 0; frame < clips[c].nFrames; frame++) {
+                pose.reset(skeleton);
+                if (clipIndices[c] >= 0)
+                    animationClips[clipIndices[c]].sample((float)frame / sampleRate, pose);
+                if (skeleton.size() > 0)
+                    compute_palette(skeleton, pose, palette.data(), globals);
+
+                size_t first = (clips[c].firstFrame + frame) * frameSize;
+                for (size_t m = 0; m < meshes.size(); m++) {
+                    const std::vector<Vertex>& vertices = meshes[m].get_vertices();
+                    const std::vector<SkinWeights>& skin = meshes[m].get_skin();
+                    for (size_t v = 0; v < vertices.size(); v++) {
+                        glm::mat4 matrix = skin.empty() ? glm::mat4(1.0f) : skin_matrix(skin[v], palette.data());
+                        size_t texel = first + vertexOffsets[m] + v;
+                        positions[texel] = matrix * glm::vec4(vertices[v].pos, 1.0f);
+                        normals[texel] = glm::vec4(glm::normalize(glm::mat3(matrix) * vertices[v].norm), 0.0f);
+                    }
+                }
+            }
+        }
+
+        // positions at full precision, half floats are enough for normals
+        GLsizei height = (GLsizei)(nFrames * rowsPerFrame);
+        glCreateTextures(GL_TEXTURE_2D, 1, &positionTexture);
+        glTextureStorage2D(positionTexture, 1, GL_RGBA32F, width, height);
+        glTextureSubImage2D(positionTexture, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, positions.data());
+        glCreateTextures(GL_TEXTURE_2D, 1, &normalTexture);
+        glTextureStorage2D(normalTexture, 1, GL_RGBA16F, width, height);
+        glTextureSubImage2D(normalTexture, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, normals.data());
+        std::cout << "Baked vertex animation: " << nVertices << " vertices, " << nFrames << " frames ("
+                  << frameSize * nFrames * 24 / (1024 * 1024) << " MiB)" << std::endl;
+    }
+
+    // textures and layout for the SKINNING shaders
+    void bind() const {
+        glBindTextureUnit(6, positionTexture);
+        glBindTextureUnit(7, normalTexture);
+        glUniform2f(45, sampleRate, (float)rowsPerFrame);
+    }
+    // first baked vertex of a mesh, set before each mesh is drawn
+    void bind_mesh(size_t iMesh) const {
+        if (iMesh < vertexOffsets.size())
+            glUniform1ui(44, vertexOffsets[iMesh]);
+    }
+
+    bool is_baked() const { return !clips.empty(); }
+
+    std::vector<Clip> clips; // in the order of bake()
+
+private:
+    std::vector<uint32_t> vertexOffsets; // per mesh
+    uint32_t rowsPerFrame = 1;
+    GLuint positionTexture = 0;
+    GLuint normalTexture = 0;
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+// Error reporting through KHR_debug output, needs a debug context (debug builds create one)
+namespace GlDebug {
+    void enable_output();
+}
+
+// Sampling tracer for GL calls: counts calls and CPU time per GL entry point and writes them to a CSV file.
+// Compiled in with ENABLE_GL_TRACER, glbinding's call callbacks are only switched on while a sampled frame is traced,
+// so the tracer costs nothing when it is not running (and everything is a no-op when compiled out).
+namespace GlTracer {
+#ifdef ENABLE_GL_TRACER
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    // trace every sampleInterval-th of the next nFrames frames, the report is written afterwards
+    void start(const std::string& path, uint32_t nFrames = 300, uint32_t sampleInterval = 10);
+    // called by the render thread after every frame
+    void end_frame();
+    bool active();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Measures the GPU time of a pass with GL_TIME_ELAPSED queries.
+// Results are read back a few frames later, so measuring never stalls the CPU.
+struct GpuTimer {
+    GpuTimer() {
+        glCreateQueries(GL_TIME_ELAPSED, (GLsizei)queries.size(), queries.data());
+    }
+    ~GpuTimer() {
+        glDeleteQueries((GLsizei)queries.size(), queries.data());
+    }
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin() {
+        collect(); // the query of this slot was issued queries.size() frames ago
+        glBeginQuery(GL_TIME_ELAPSED, queries[index]);
+    }
+    void end() {
+        glEndQuery(GL_TIME_ELAPSED);
+        bPending[index] = true;
+        index = (index + 1) % queries.size();
+    }
+
+    float lastMs = 0.0f;   // newest available result
+    double totalMs = 0.0;  // sum of all results
+    uint64_t nSamples = 0;
+
+private:
+    void collect() {
+        if (!bPending[index]) return;
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &nanoseconds);
+        bPending[index] = false;
+        lastMs = (float)nanoseconds * 0.000001f;
+        totalMs += lastMs;
+        nSamples++;
+    }
+
+    std::array<GLuint, 4> queries;
+    std::array<bool, 4> bPending = {};
+    size_t index = 0;
+};
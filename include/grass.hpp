@@ -0,0 +1,137 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <stb_image.h>
+//
+#include "pipeline.hpp"
+#include "render_stats.hpp"
+#include "utils.hpp"
+#include "heightfield.hpp"
+#include "game_objects/camera.hpp"
+
+// Procedural grass over the arena. Every frame a compute pass walks a fixed window of tiles around the camera,
+// culls whole tiles against the frustum and spawns the blades of the visible ones into an instance buffer
+// (spots hashed from tile and blade index, density from images/grass.png, thinned out with distance, on the terrain heights).
+// One indirect draw with the instance count of the compute pass draws them, grass.vs shapes and bends the blades.
+// The window and the blades per tile bound the cost, however large the arena is.
+struct Grass {
+    static constexpr float tileSize = 8.0f;           // meters
+    static constexpr uint32_t windowTiles = 10;       // per side, centered on the camera tile
+    static constexpr uint32_t bladesPerTile = 2048;   // at full density, 32 per square meter
+    static constexpr uint32_t capacity = windowTiles * windowTiles * bladesPerTile;
+    static constexpr float fullDensityDistance = 10.0f;
+    static constexpr float maxDistance = tileSize * windowTiles * 0.5f; // nothing left at the window border
+    static constexpr float maxBladeHeight = 0.6f;     // meters
+
+    Grass(glm::vec3 minBounds, glm::vec3 maxBounds, const Heightfield& heightfield, uint32_t nLights)
+        : minBounds(minBounds), maxBounds(maxBounds), heightfield(heightfield),
+          drawPipeline("shaders/grass.vs", "shaders/grass.fs", {"N_LIGHTS " + std::to_string(nLights)}) {
+        glCreateBuffers(1, &bladeBuffer);
+        glNamedBufferStorage(bladeBuffer, capacity * sizeof(GpuBlade), nullptr, BufferStorageMask::GL_NONE_BIT);
+        DrawCommand command = { 7, 0, 0, 0 };
+        glCreateBuffers(1, &indirectBuffer);
+        glNamedBufferStorage(indirectBuffer, sizeof(command), &command, BufferStorageMask::GL_NONE_BIT);
+        glCreateVertexArrays(1, &vao); // blades are generated from gl_VertexID/gl_InstanceID
+        load_density_map();
+    }
+    ~Grass() {
+        GLuint buffers[] = { bladeBuffer, indirectBuffer };
+        glDeleteBuffers(2, buffers);
+        glDeleteTextures(1, &densityMap);
+        glDeleteVertexArrays(1, &vao);
+    }
+    Grass(const Grass&) = delete;
+    Grass& operator=(const Grass&) = delete;
+
+    // culls the tiles of the window and spawns the blades for this view
+    void update(const Camera& camera) {
+        glm::ivec2 cameraTile = glm::ivec2(glm::floor(glm::vec2(camera.position.x, camera.position.z) / tileSize));
+        glm::ivec2 windowOrigin = cameraTile - glm::ivec2(windowTiles / 2);
+        glm::vec4 planes[6];
+        camera.frustum_planes(planes);
+
+        // zero the instance count of the draw, keep the vertex count
+        glClearNamedBufferSubData(indirectBuffer, GL_R32UI, offsetof(DrawCommand, instanceCount), sizeof(uint32_t), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        cullPipeline.bind();
+        glUniform4fv(0, 6, glm::value_ptr(planes[0]));
+        glUniform3f(6, camera.position.x, camera.position.y, camera.position.z);
+        glUniform2i(7, windowOrigin.x, windowOrigin.y);
+        glUniform4f(8, minBounds.x, minBounds.z, maxBounds.x, maxBounds.z);
+        glUniform4f(9, tileSize, fullDensityDistance, maxDistance, maxBladeHeight);
+        glUniform1ui(10, bladesPerTile);
+        glUniform4f(11, heightfield.amplitude, heightfield.wavelength, heightfield.flatExtent, heightfield.rampWidth);
+        glUniform1ui(12, heightfield.seed);
+        glBindTextureUnit(0, densityMap);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, bladeBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, indirectBuffer);
+        glDispatchCompute(windowTiles, windowTiles, 1);
+        glMemoryBarrier(MemoryBarrierMask::GL_SHADER_STORAGE_BARRIER_BIT | MemoryBarrierMask::GL_COMMAND_BARRIER_BIT);
+    }
+
+    // binds pipeline and camera, the caller binds the lights (locations of default.fs) before draw()
+    void bind(Camera& camera, float time) {
+        drawPipeline.bind();
+        camera.bind();
+        glUniform1f(40, time);
+        glUniform4f(41, windDirection.x, windDirection.y, windStrength, windWaveLength);
+    }
+    void draw() {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, bladeBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBindVertexArray(vao);
+        glDrawArraysIndirect(GL_TRIANGLE_STRIP, nullptr);
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        RenderStats::get().counters().drawCalls++; // the blade count stays on the GPU
+    }
+
+    glm::vec2 windDirection = glm::normalize(glm::vec2(1.0f, 0.4f));
+    float windStrength = 0.35f;   // lean of the tip at the peak of a gust
+    float windWaveLength = 12.0f; // meters between gusts
+
+private:
+    struct GpuBlade {
+        glm::vec4 positionYaw;
+        glm::vec4 shape; // height, width, bend, color variation
+    };
+    struct DrawCommand { // layout of glDrawArraysIndirect
+        uint32_t vertexCount;
+        uint32_t instanceCount;
+        uint32_t firstVertex;
+        uint32_t baseInstance;
+    };
+
+    // green channel = density, everywhere full density if the image is missing
+    void load_density_map() {
+        int width = 1, height = 1, nChannels;
+        auto image = load_image("images/grass.png");
+        stbi_uc* pImage = image.first ? stbi_load_from_memory(image.first, (int)image.second, &width, &height, &nChannels, 4) : nullptr;
+        stbi_uc white[4] = { 255, 255, 255, 255 };
+        if (pImage == nullptr) {
+            std::cerr << "failed to load grass density map" << std::endl;
+            width = height = 1;
+        }
+        glCreateTextures(GL_TEXTURE_2D, 1, &densityMap);
+        glTextureStorage2D(densityMap, 1, GL_RGBA8, width, height);
+        glTextureSubImage2D(densityMap, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pImage ? pImage : white);
+        glTextureParameteri(densityMap, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(densityMap, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(densityMap, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(densityMap, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (pImage) stbi_image_free(pImage);
+    }
+
+    glm::vec3 minBounds, maxBounds; // arena
+    Heightfield heightfield; // the blades stand on the terrain
+    GLuint bladeBuffer;
+    GLuint indirectBuffer;
+    GLuint densityMap;
+    GLuint vao;
+    Pipeline cullPipeline = Pipeline({{GL_COMPUTE_SHADER, "shaders/grass_cull.comp"}});
+    Pipeline drawPipeline;
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+// Procedural ground height, pure functions of the position so every thread (and grass_cull.comp) gets the same numbers.
+// A few octaves of value noise make hills that flatten out towards the static environment model in the middle.
+// The surface is the triangulated grid of samples every `spacing` meters, height() is exact on the LOD 0 terrain mesh.
+struct Heightfield {
+    static constexpr int nOctaves = 4;
+
+    // height at a grid point of the surface (defined everywhere, between grid points the surface is planar)
+    float sample(float x, float z) const {
+        float border = std::max(std::abs(x), std::abs(z));
+        if (border <= flatExtent) return 0.0f; // the environment model lies on y = 0
+        float hills = 0.0f;
+        float frequency = 1.0f / wavelength;
+        float weight = 0.5f;
+        for (int octave = 0; octave < nOctaves; octave++) {
+            hills += value_noise(x * frequency, z * frequency, seed + (uint32_t)octave) * weight;
+            frequency *= 2.0f;
+            weight *= 0.5f;
+        }
+        float ramp = std::clamp((border - flatExtent) / rampWidth, 0.0f, 1.0f);
+        return hills * amplitude * ramp * ramp * (3.0f - 2.0f * ramp);
+    }
+
+    // height of the surface, both triangles of a grid cell share the diagonal from (x0, z0) to (x0 + 1, z0 + 1)
+    float height(float x, float z) const {
+        float cellX = std::floor(x / spacing);
+        float cellZ = std::floor(z / spacing);
+        float fx = x / spacing - cellX;
+        float fz = z / spacing - cellZ;
+        float x0 = cellX * spacing, z0 = cellZ * spacing;
+        float h00 = sample(x0, z0);
+        float h11 = sample(x0 + spacing, z0 + spacing);
+        if (fx >= fz) {
+            float h10 = sample(x0 + spacing, z0);
+            return h00 + (h10 - h00) * fx + (h11 - h10) * fz;
+        }
+        float h01 = sample(x0, z0 + spacing);
+        return h00 + (h01 - h00) * fz + (h11 - h01) * fx;
+    }
+    float height(glm::vec3 position) const { return height(position.x, position.z); }
+
+    // surface normal of the continuous height function (smooth shading of the terrain mesh)
+    glm::vec3 normal(float x, float z) const {
+        float dx = sample(x + spacing, z) - sample(x - spacing, z);
+        float dz = sample(x, z + spacing) - sample(x, z - spacing);
+        return glm::normalize(glm::vec3(-dx, 2.0f * spacing, -dz));
+    }
+
+    float max_height() const { return amplitude; } // the hills stay below
+
+    uint32_t seed = 1337;
+    float spacing = 1.0f;     // meters between grid points
+    float amplitude = 12.0f;  // meters
+    float wavelength = 96.0f; // meters, of the first octave
+    float flatExtent = 40.0f; // half size of the flat middle
+    float rampWidth = 40.0f;  // the hills rise over this distance
+
+private:
+    // same hash as particle_effects.hpp
+    static uint32_t hash(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+    static float lattice(int32_t x, int32_t z, uint32_t seed) {
+        return (float)(hash((uint32_t)x * 73856093u ^ (uint32_t)z * 19349663u ^ seed) >> 8) * (1.0f / 16777216.0f);
+    }
+    // smoothly interpolated random values at integer coordinates, in [0, 1)
+    static float value_noise(float x, float z, uint32_t seed) {
+        float cellX = std::floor(x);
+        float cellZ = std::floor(z);
+        float fx = x - cellX;
+        float fz = z - cellZ;
+        fx = fx * fx * fx * (fx * (fx * 6.0f - 15.0f) + 10.0f);
+        fz = fz * fz * fz * (fz * (fz * 6.0f - 15.0f) + 10.0f);
+        int32_t ix = (int32_t)cellX;
+        int32_t iz = (int32_t)cellZ;
+        float a = lattice(ix, iz, seed) + (lattice(ix + 1, iz, seed) - lattice(ix, iz, seed)) * fx;
+        float b = lattice(ix, iz + 1, seed) + (lattice(ix + 1, iz + 1, seed) - lattice(ix, iz + 1, seed)) * fx;
+        return a + (b - a) * fz;
+    }
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cfloat>
+#include <algorithm>
+#include <glm/glm.hpp>
+//
+#include "pipeline.hpp"
+#include "stream_buffer.hpp"
+#include "game_objects/model.hpp"
+#include "game_objects/camera.hpp"
+
+// Octahedral impostor of a model: views from the upper hemisphere (hemi-octahedral grid of nFrames x nFrames)
+// are baked into an albedo and a normal atlas at load time. Far instances are drawn as quads that show the
+// nearest baked view and are lit with the baked normals. Between fadeRange.x and .y the quad dithers in while
+// the mesh dithers out with the complementary pattern (default.fs), so both can be drawn opaque.
+struct Impostor {
+    static constexpr uint32_t nFrames = 8;      // per atlas side
+    static constexpr uint32_t frameSize = 128;  // pixels per view
+    static constexpr uint32_t atlasSize = nFrames * frameSize;
+
+    Impostor(Model& model, uint32_t nLights) : drawPipeline("shaders/impostor.vs", "shaders/impostor.fs", {"N_LIGHTS " + std::to_string(nLights)}) {
+        glCreateVertexArrays(1, &vao); // quads are generated from gl_VertexID/gl_InstanceID
+        bake(model);
+    }
+    ~Impostor() {
+        GLuint textures[] = { albedoTexture, normalTexture };
+        glDeleteTextures(2, textures);
+        glDeleteVertexArrays(1, &vao);
+    }
+    Impostor(const Impostor&) = delete;
+    Impostor& operator=(const Impostor&) = delete;
+
+    // view direction of an atlas frame (object space, y up), must match hemi_octahedral_decode in impostor.vs
+    static glm::vec3 frame_direction(uint32_t x, uint32_t y) {
+        glm::vec2 uv = glm::vec2(x, y) / (float)(nFrames - 1) * 2.0f - 1.0f;
+        glm::vec2 p = glm::vec2(uv.x + uv.y, uv.x - uv.y) * 0.5f;
+        return glm::normalize(glm::vec3(p.x, 1.0f - std::abs(p.x) - std::abs(p.y), p.y));
+    }
+
+    void update(const std::vector<Transform>& instances, StreamBuffer& streamBuffer) {
+        count = 0;
+        range = streamBuffer.allocate(instances.size() * sizeof(GpuInstance), streamBuffer.storage_alignment());
+        if (!range || instances.empty()) return;
+        GpuInstance* gpuInstances = (GpuInstance*)range.data;
+        for (size_t i = 0; i < instances.size(); i++)
+            gpuInstances[i] = {glm::vec4(instances[i].position, instances[i].scale.x), glm::vec4(instances[i].rotation.x, 0.0f, 0.0f, 0.0f)}; // yaw only
+        count = (uint32_t)instances.size();
+    }
+
+    // binds pipeline, camera and atlas, the caller binds the lights (locations of default.fs) before draw()
+    void bind(Camera& camera, GLuint streamBuffer) {
+        drawPipeline.bind();
+        camera.bind();
+        glUniform4f(47, center.x, center.y, center.z, radius);
+        glUniform1f(48, (float)nFrames);
+        glBindTextureUnit(8, albedoTexture);
+        glBindTextureUnit(9, normalTexture);
+        if (count > 0)
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 5, streamBuffer, range.offset, range.size);
+    }
+    void draw(glm::vec2 fadeRange) {
+        if (count == 0) return;
+        glUniform2f(46, fadeRange.x, fadeRange.y);
+        glBindVertexArray(vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        glBindVertexArray(0);
+        RenderStats::get().counters().drawCalls++;
+        RenderStats::get().counters().triangles += 2 * count;
+    }
+
+    uint32_t get_count() const { return count; }
+
+private:
+    struct GpuInstance {
+        glm::vec4 positionScale;
+        glm::vec4 rotation;
+    };
+    struct SkinnedInstance { // layout of the SKINNING shaders
+        glm::mat4 modelMatrix;
+        glm::uvec4 animation;
+    };
+
+    void bake(Model& model) {
+        // the first idle frame for skinned models, mesh space otherwise
+        bool bSkinned = model.skeleton.size() > 0;
+        std::vector<glm::mat4> palette(std::max<size_t>(model.skeleton.size(), 1), glm::mat4(1.0f));
+        if (bSkinned) {
+            Pose pose;
+            pose.reset(model.skeleton);
+            if (model.idleClip >= 0)
+                model.clips[model.idleClip].sample(0.0f, pose);
+            std::vector<glm::mat4> globals;
+            compute_palette(model.skeleton, pose, palette.data(), globals);
+        }
+
+        // bounding sphere of the posed vertices
+        glm::vec3 minimum = glm::vec3(FLT_MAX);
+        glm::vec3 maximum = glm::vec3(-FLT_MAX);
+        for (const Mesh& mesh : model.get_meshes()) {
+            const std::vector<Vertex>& vertices = mesh.get_vertices();
+            const std::vector<SkinWeights>& skin = mesh.get_skin();
+            for (size_t v = 0; v < vertices.size(); v++) {
+                glm::vec3 position = skin.empty() ? vertices[v].pos : glm::vec3(skin_matrix(skin[v], palette.data()) * glm::vec4(vertices[v].pos, 1.0f));
+                minimum = glm::min(minimum, position);
+                maximum = glm::max(maximum, position);
+            }
+        }
+        if (minimum.x > maximum.x) return; // no vertices
+        center = (minimum + maximum) * 0.5f;
+        radius = std::max(glm::length(maximum - minimum) * 0.5f, 0.001f);
+
+        // atlas (mip-mapped, the quads get small) and a temporary depth buffer
+        GLsizei nLevels = 5;
+        glCreateTextures(GL_TEXTURE_2D, 1, &albedoTexture);
+        glTextureStorage2D(albedoTexture, nLevels, GL_RGBA8, atlasSize, atlasSize);
+        glCreateTextures(GL_TEXTURE_2D, 1, &normalTexture);
+        glTextureStorage2D(normalTexture, nLevels, GL_RGBA8, atlasSize, atlasSize);
+        for (GLuint texture : {albedoTexture, normalTexture}) {
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        GLuint depthBuffer, framebuffer;
+        glCreateRenderbuffers(1, &depthBuffer);
+        glNamedRenderbufferStorage(depthBuffer, GL_DEPTH_COMPONENT32F, atlasSize, atlasSize);
+        glCreateFramebuffers(1, &framebuffer);
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, albedoTexture, 0);
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT1, normalTexture, 0);
+        glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glNamedFramebufferDrawBuffers(framebuffer, 2, drawBuffers);
+        float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float clearDepth = 1.0f;
+        glClearNamedFramebufferfv(framebuffer, GL_COLOR, 0, clearColor);
+        glClearNamedFramebufferfv(framebuffer, GL_COLOR, 1, clearColor);
+        glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &clearDepth);
+
+        // skinned models are drawn as a single instance with the posed palette
+        Pipeline bakePipeline = bSkinned ? Pipeline("shaders/default.vs", "shaders/impostor_bake.fs", {"SKINNING"}) : Pipeline("shaders/default.vs", "shaders/impostor_bake.fs");
+        GLuint buffers[2] = { 0, 0 };
+        bakePipeline.bind();
+        if (bSkinned) {
+            SkinnedInstance instance = { glm::mat4(1.0f), glm::uvec4(0) };
+            glCreateBuffers(2, buffers);
+            glNamedBufferStorage(buffers[0], sizeof(instance), &instance, BufferStorageMask::GL_NONE_BIT);
+            glNamedBufferStorage(buffers[1], palette.size() * sizeof(glm::mat4), palette.data(), BufferStorageMask::GL_NONE_BIT);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, buffers[0]);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffers[1]);
+        }
+
+        // one orthographic view per frame, the quads in impostor.vs use the same axes
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glEnable(GL_DEPTH_TEST);
+        glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 4.0f * radius);
+        glUniformMatrix4fv(8, 1, false, glm::value_ptr(projection));
+        for (uint32_t y = 0; y < nFrames; y++) {
+            for (uint32_t x = 0; x < nFrames; x++) {
+                glm::vec3 direction = frame_direction(x, y);
+                glm::vec3 reference = std::abs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, -1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                glm::mat4 view = glm::lookAt(center + direction * 2.0f * radius, center, reference);
+                glUniformMatrix4fv(4, 1, false, glm::value_ptr(view));
+                glViewport(x * frameSize, y * frameSize, frameSize, frameSize);
+                if (bSkinned) model.draw_instanced(1);
+                else model.draw(Transform());
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glGenerateTextureMipmap(albedoTexture);
+        glGenerateTextureMipmap(normalTexture);
+
+        if (bSkinned) glDeleteBuffers(2, buffers);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+    }
+
+    glm::vec3 center = glm::vec3(0.0f); // bounding sphere in object space
+    float radius = 1.0f;
+    GLuint albedoTexture = 0; // rgb = color * diffuse, a = coverage
+    GLuint normalTexture = 0; // rgb = object space normal, a = ambient
+    GLuint vao;
+    uint32_t count = 0;
+    StreamBuffer::Allocation range;
+    Pipeline drawPipeline;
+};
@@ -9,19 +9,48 @@
 //
 #include <string_view>
 #include <cstdint>
-#include <set>
+#include <bitset>
+#include "spsc_ring.hpp"
 
+// Keyboard/mouse state of the simulation thread.
+// The thread that polls SDL pushes compact timestamped events into a lock-free ring (push_event),
+// the simulation thread applies them to the bitsets once per tick (poll), so every query is O(1).
 namespace Input {
+	struct Event {
+		enum class Type : uint8_t { eKeyDown, eKeyUp, eButtonDown, eButtonUp, eMotion };
+		Type type;
+		uint8_t button;
+		SDL_Keycode key;
+		float dx, dy;
+		uint64_t timestamp; // SDL event time in nanoseconds
+	};
+
+	// character keycodes map to their own value, keycodes of special keys (scancode | SDLK_SCANCODE_MASK) are moved behind them
+	static constexpr size_t nKeyCodes = 512;
+	static constexpr size_t nKeys = 2 * nKeyCodes;
+	static constexpr size_t key_index(SDL_Keycode code) noexcept {
+		if (code & SDLK_SCANCODE_MASK) return nKeyCodes + ((code & ~SDLK_SCANCODE_MASK) & (nKeyCodes - 1));
+		return (size_t)code < nKeyCodes ? (size_t)code : 0; // index 0 (SDLK_UNKNOWN) collects unsupported characters
+	}
+	static constexpr size_t char_index(char character) noexcept {
+		// letters are reported as lowercase keycodes
+		if (character >= 'A' && character <= 'Z') character += 'a' - 'A';
+		return key_index((unsigned char)character);
+	}
+
 	struct Data {
 		static Data& get() noexcept { static Data instance; return instance; }
-		std::set<SDL_Keycode> keysPressed;
-		std::set<SDL_Keycode> keysDown;
-		std::set<SDL_Keycode> keysReleased;
-		std::set<uint8_t> buttonsPressed;
-		std::set<uint8_t> buttonsDown;
-		std::set<uint8_t> buttonsReleased;
+		std::bitset<nKeys> keysPressed;
+		std::bitset<nKeys> keysDown;
+		std::bitset<nKeys> keysReleased;
+		std::bitset<8> buttonsPressed;
+		std::bitset<8> buttonsDown;
+		std::bitset<8> buttonsReleased;
 		float x, y;
 		float dx, dy;
+		uint64_t timestamp = 0; // time of the newest applied event
+		SpscRing<Event, 1024> events;
+		uint64_t droppedEvents = 0; // producer side, events that did not fit into the ring
 	};
 
 	struct Keys {
@@ -31,84 +60,127 @@ namespace Input {
             }
             return false;
         }
-		static inline bool pressed(char character) noexcept { return Data::get().keysPressed.contains(character) || Data::get().keysPressed.contains(character + 32); }
-		static inline bool pressed(SDL_KeyCode code) noexcept { return Data::get().keysPressed.contains(code); }
+		static inline bool pressed(char character) noexcept { return Data::get().keysPressed[char_index(character)]; }
+		static inline bool pressed(SDL_KeyCode code) noexcept { return Data::get().keysPressed[key_index(code)]; }
         static inline bool down(std::string_view characters) noexcept {
             for (auto cur = characters.cbegin(); cur < characters.cend(); cur++) {
                 if (down(*cur)) return true;
             }
             return false;
         }
-		static inline bool down(char character) noexcept { return Data::get().keysDown.contains(character) || Data::get().keysPressed.contains(character + 32); }
-		static inline bool down(SDL_KeyCode code) noexcept { return Data::get().keysDown.contains(code); }
+		static inline bool down(char character) noexcept { return Data::get().keysDown[char_index(character)]; }
+		static inline bool down(SDL_KeyCode code) noexcept { return Data::get().keysDown[key_index(code)]; }
         static inline bool released(std::string_view characters) noexcept {
             for (auto cur = characters.cbegin(); cur < characters.cend(); cur++) {
                 if (released(*cur)) return true;
             }
             return false;
         }
-		static inline bool released(char character) noexcept { return Data::get().keysReleased.contains(character) || Data::get().keysPressed.contains(character + 32); }
-		static inline bool released(SDL_KeyCode code) noexcept { return Data::get().keysReleased.contains(code); }
+		static inline bool released(char character) noexcept { return Data::get().keysReleased[char_index(character)]; }
+		static inline bool released(SDL_KeyCode code) noexcept { return Data::get().keysReleased[key_index(code)]; }
     };
 	struct Mouse {
 		struct ids { static constexpr uint8_t left = SDL_BUTTON_LEFT, right = SDL_BUTTON_RIGHT, middle = SDL_BUTTON_MIDDLE; };
-		static inline bool pressed(uint8_t buttonID) noexcept { return Data::get().buttonsPressed.contains(buttonID); }
-		static inline bool down(uint8_t buttonID) noexcept { return Data::get().buttonsDown.contains(buttonID); }
-		static inline bool released(uint8_t buttonID) noexcept { return Data::get().buttonsReleased.contains(buttonID); }
+		static inline bool pressed(uint8_t buttonID) noexcept { return Data::get().buttonsPressed[buttonID & 7]; }
+		static inline bool down(uint8_t buttonID) noexcept { return Data::get().buttonsDown[buttonID & 7]; }
+		static inline bool released(uint8_t buttonID) noexcept { return Data::get().buttonsReleased[buttonID & 7]; }
 		static inline std::pair<decltype(Data::x), decltype(Data::y)> position() noexcept { return std::pair(Data::get().x, Data::get().y); };
 		static inline std::pair<decltype(Data::dx), decltype(Data::dy)> delta() noexcept { return std::pair(Data::get().dx, Data::get().dy); };
 	};
 	
     static void flush() noexcept {
-		Data::get().keysPressed.clear();
-		Data::get().keysReleased.clear();
-		Data::get().buttonsPressed.clear();
-		Data::get().buttonsReleased.clear();
+		Data::get().keysPressed.reset();
+		Data::get().keysReleased.reset();
+		Data::get().buttonsPressed.reset();
+		Data::get().buttonsReleased.reset();
 		Data::get().dx = 0;
 		Data::get().dy = 0;
 	}
 	static void flush_all() noexcept {
 		flush();
-		Data::get().keysDown.clear();
-		Data::get().buttonsDown.clear();
+		Data::get().keysDown.reset();
+		Data::get().buttonsDown.reset();
 	}
-	static void register_key_up(SDL_KeyboardEvent& keyEvent) noexcept {
-		if (keyEvent.repeat || IMGUI_CAPTURE_EVAL) return;
-		Data::get().keysReleased.insert(keyEvent.keysym.sym);
-		Data::get().keysDown.erase(keyEvent.keysym.sym);
+
+	// consumer side: apply a single event to the key/button state
+	static void apply_event(const Event& event) noexcept {
+		Data& data = Data::get();
+		switch (event.type) {
+			case Event::Type::eKeyDown:
+				data.keysPressed.set(key_index(event.key));
+				data.keysDown.set(key_index(event.key));
+				break;
+			case Event::Type::eKeyUp:
+				data.keysReleased.set(key_index(event.key));
+				data.keysDown.reset(key_index(event.key));
+				break;
+			case Event::Type::eButtonDown:
+				data.buttonsPressed.set(event.button & 7);
+				data.buttonsDown.set(event.button & 7);
+				break;
+			case Event::Type::eButtonUp:
+				data.buttonsReleased.set(event.button & 7);
+				data.buttonsDown.reset(event.button & 7);
+				break;
+			case Event::Type::eMotion:
+				data.dx += event.dx;
+				data.dy += event.dy;
+				data.x += event.dx;
+				data.y += event.dy;
+				break;
+		}
+		data.timestamp = event.timestamp;
 	}
-	static void register_key_down(SDL_KeyboardEvent& keyEvent) noexcept {
-		if (keyEvent.repeat || IMGUI_CAPTURE_EVAL) return;
-		Data::get().keysPressed.insert(keyEvent.keysym.sym);
-		Data::get().keysDown.insert(keyEvent.keysym.sym);
+	// consumer side: flush the state of the last tick and apply all events up to the given time,
+	// every applied event is also handed to the callback (e.g. for recording)
+	template<typename Callback>
+	static void poll(Callback&& on_event, uint64_t until = UINT64_MAX) noexcept {
+		flush();
+		auto& events = Data::get().events;
+		while (const Event* pEvent = events.peek()) {
+			if (pEvent->timestamp > until) break;
+			apply_event(*pEvent);
+			on_event(*pEvent);
+			events.pop();
+		}
 	}
-	static void register_button_up(SDL_MouseButtonEvent& buttonEvent) noexcept {
-		if (IMGUI_CAPTURE_EVAL) return;
-		Data::get().buttonsReleased.insert(buttonEvent.button);
-		Data::get().buttonsDown.erase(buttonEvent.button);
+	static void poll(uint64_t until = UINT64_MAX) noexcept {
+		poll([](const Event&) {}, until);
 	}
-	static void register_button_down(SDL_MouseButtonEvent& buttonEvent) noexcept {
-		if (IMGUI_CAPTURE_EVAL) return;
-		std::string buttonString = std::to_string(buttonEvent.button);
-		Data::get().buttonsPressed.insert(buttonEvent.button);
-		Data::get().buttonsDown.insert(buttonEvent.button);
+	// consumer side: flush the state of the last tick and drop all queued events (input comes from somewhere else, e.g. a replay)
+	static void discard() noexcept {
+		flush();
+		auto& events = Data::get().events;
+		while (events.peek()) events.pop();
 	}
-	static void register_motion(SDL_MouseMotionEvent& motionEvent) noexcept {
-		Data::get().dx += motionEvent.xrel;
-		Data::get().dy += motionEvent.yrel;
-		Data::get().x += motionEvent.xrel;
-		Data::get().y += motionEvent.yrel;
+
+	// producer side: convert SDL events into compact input events (called by the thread that polls SDL)
+	static void push_event(const SDL_Event& sdlEvent) noexcept {
+		Event event = {};
+		event.timestamp = sdlEvent.common.timestamp;
+		switch (sdlEvent.type) {
+			case SDL_EventType::SDL_EVENT_KEY_UP:
+			case SDL_EventType::SDL_EVENT_KEY_DOWN:
+				if (sdlEvent.key.repeat || IMGUI_CAPTURE_EVAL) return;
+				event.type = sdlEvent.type == SDL_EventType::SDL_EVENT_KEY_DOWN ? Event::Type::eKeyDown : Event::Type::eKeyUp;
+				event.key = sdlEvent.key.keysym.sym;
+				break;
+			case SDL_EventType::SDL_EVENT_MOUSE_BUTTON_UP:
+			case SDL_EventType::SDL_EVENT_MOUSE_BUTTON_DOWN:
+				if (IMGUI_CAPTURE_EVAL) return;
+				event.type = sdlEvent.type == SDL_EventType::SDL_EVENT_MOUSE_BUTTON_DOWN ? Event::Type::eButtonDown : Event::Type::eButtonUp;
+				event.button = sdlEvent.button.button;
+				break;
+			case SDL_EventType::SDL_EVENT_MOUSE_MOTION:
+				event.type = Event::Type::eMotion;
+				event.dx = sdlEvent.motion.xrel;
+				event.dy = sdlEvent.motion.yrel;
+				break;
+			default: return;
+		}
+		if (!Data::get().events.push(event)) Data::get().droppedEvents++;
 	}
-    static void register_event(SDL_Event& event) noexcept {
-        switch(event.type) {
-            case SDL_EventType::SDL_EVENT_KEY_UP: register_key_up(event.key); break;
-            case SDL_EventType::SDL_EVENT_KEY_DOWN: register_key_down(event.key); break;
-            case SDL_EventType::SDL_EVENT_MOUSE_MOTION: register_motion(event.motion); break;
-            case SDL_EventType::SDL_EVENT_MOUSE_BUTTON_UP: register_button_up(event.button); break;
-            case SDL_EventType::SDL_EVENT_MOUSE_BUTTON_DOWN: register_button_down(event.button); break;
-        }
-    }
 }
 #undef IMGUI_CAPTURE_EVAL
 typedef Input::Keys Keys;
-typedef Input::Mouse Mouse;
\ No newline at end of file
+typedef Input::Mouse Mouse;
@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+//
+#include "input.hpp"
+
+// Seed and per-tick input stream of a play session, saved as a compact binary file so the session can be replayed exactly
+struct InputRecording {
+    struct Entry {
+        uint32_t tick;
+        Input::Event event;
+    };
+
+    // recording side (simulation thread)
+    void record(uint32_t tick, const Input::Event &event) {
+        entries.push_back({tick, event});
+    }
+
+    // replay side: applies the events of the given tick to the input state, returns false once the recording is over
+    bool replay(uint32_t tick, uint64_t timestamp) {
+        for (; cursor < entries.size() && entries[cursor].tick <= tick; cursor++) {
+            Input::Event event = entries[cursor].event;
+            event.timestamp = timestamp; // the recorded times are meaningless now
+            Input::apply_event(event);
+        }
+        return tick < nTicks;
+    }
+
+    bool save(const std::string &path) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to write input recording " << path << std::endl;
+            return false;
+        }
+
+        uint32_t header[] = {magic, version, seed, tickRate, nTicks, (uint32_t)entries.size()};
+        file.write((const char *)header, sizeof(header));
+        for (auto &entry : entries) {
+            // 18 bytes per event, the timestamp is not stored
+            uint8_t type = (uint8_t)entry.event.type;
+            int32_t key = (int32_t)entry.event.key;
+            file.write((const char *)&entry.tick, sizeof(entry.tick));
+            file.write((const char *)&type, sizeof(type));
+            file.write((const char *)&entry.event.button, sizeof(entry.event.button));
+            file.write((const char *)&key, sizeof(key));
+            file.write((const char *)&entry.event.dx, sizeof(entry.event.dx));
+            file.write((const char *)&entry.event.dy, sizeof(entry.event.dy));
+        }
+        std::cout << "Saved input recording " << path << " (" << nTicks << " ticks, " << entries.size() << " events)" << std::endl;
+        return true;
+    }
+
+    bool load(const std::string &path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        uint64_t fileSize = file ? (uint64_t)file.tellg() : 0;
+        file.seekg(0);
+        uint32_t header[6];
+        if (!file.read((char *)header, sizeof(header)) || header[0] != magic || header[1] != version) {
+            std::cerr << "Failed to read input recording " << path << std::endl;
+            return false;
+        }
+        // the event count must match the rest of the file, a broken header must not allocate gigabytes
+        if ((uint64_t)header[5] * entrySize != fileSize - sizeof(header)) {
+            std::cerr << "Input recording " << path << " has " << header[5] << " events in its header, but "
+                      << fileSize - sizeof(header) << " bytes of events" << std::endl;
+            return false;
+        }
+        seed = header[2];
+        tickRate = header[3];
+        nTicks = header[4];
+
+        entries.resize(header[5]);
+        for (auto &entry : entries) {
+            uint8_t type;
+            int32_t key;
+            file.read((char *)&entry.tick, sizeof(entry.tick));
+            file.read((char *)&type, sizeof(type));
+            file.read((char *)&entry.event.button, sizeof(entry.event.button));
+            file.read((char *)&key, sizeof(key));
+            file.read((char *)&entry.event.dx, sizeof(entry.event.dx));
+            file.read((char *)&entry.event.dy, sizeof(entry.event.dy));
+            entry.event.type = (Input::Event::Type)type;
+            entry.event.key = (SDL_Keycode)key;
+        }
+        if (!file) {
+            std::cerr << "Input recording " << path << " is truncated" << std::endl;
+            entries.clear();
+            return false;
+        }
+        cursor = 0;
+        return true;
+    }
+
+    uint32_t seed = 0;
+    uint32_t tickRate = 0;
+    uint32_t nTicks = 0;
+    std::vector<Entry> entries;
+
+private:
+    static constexpr uint32_t magic = 0x52495343; // "CSIR" (little endian)
+    static constexpr uint32_t version = 1;
+    static constexpr uint64_t entrySize = sizeof(Entry::tick) + sizeof(uint8_t) + sizeof(Input::Event::button) + sizeof(int32_t)
+                                        + sizeof(Input::Event::dx) + sizeof(Input::Event::dy);
+    size_t cursor = 0;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+// Fixed set of worker threads for data parallel loops (render thread side, e.g. animation evaluation).
+// parallel_for hands out chunks through an atomic counter, the calling thread works along and returns when all chunks are done.
+struct JobPool {
+    JobPool(size_t nWorkers = default_workers()) {
+        for (size_t i = 0; i < nWorkers; i++)
+            workers.emplace_back([this] { work(); });
+    }
+    ~JobPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bStop = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    // calls function(begin, end) for all chunks of [0, count)
+    template<typename F>
+    void parallel_for(size_t count, size_t chunkSize, F& function) {
+        size_t chunks = (count + chunkSize - 1) / chunkSize;
+        if (chunks <= 1 || workers.empty()) {
+            if (count > 0) function(0, count);
+            return;
+        }
+        Loop current = { [](void* context, size_t begin, size_t end) { (*(F*)context)(begin, end); }, &function, count, chunkSize, chunks };
+        {
+            // late workers of the last loop still claim from the chunk counter, it is only reset once they all left
+            std::unique_lock<std::mutex> lock(mutex);
+            while (nActive.load(std::memory_order_acquire) > 0) {
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+            }
+            loop = current;
+            chunksDone.store(0, std::memory_order_relaxed);
+            nextChunk.store(0, std::memory_order_relaxed);
+            generation++;
+        }
+        wake.notify_all();
+        run_chunks(current);
+        while (chunksDone.load(std::memory_order_acquire) < chunks)
+            std::this_thread::yield();
+    }
+
+    size_t size() const { return workers.size() + 1; } // including the calling thread
+
+    static size_t default_workers() {
+        // the simulation and render threads are busy already
+        return std::clamp<size_t>(std::thread::hardware_concurrency(), 3, 10) - 2;
+    }
+
+private:
+    struct Loop {
+        void (*job)(void*, size_t, size_t);
+        void* context;
+        size_t count;
+        size_t chunkSize;
+        size_t nChunks;
+    };
+
+    void work() {
+        uint64_t seen = 0;
+        while (true) {
+            Loop current;
+            {
+                // the loop is copied and the worker counted under the lock, so parallel_for can't publish the next one in between
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return bStop || generation != seen; });
+                if (bStop) return;
+                seen = generation;
+                current = loop;
+                nActive.fetch_add(1, std::memory_order_relaxed);
+            }
+            run_chunks(current);
+            nActive.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    void run_chunks(const Loop& current) {
+        for (size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < current.nChunks;
+             chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+            size_t begin = chunk * current.chunkSize;
+            current.job(current.context, begin, std::min(begin + current.chunkSize, current.count));
+            chunksDone.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    uint64_t generation = 0;
+    bool bStop = false;
+    Loop loop = {}; // current loop, guarded by the mutex
+    std::atomic<size_t> nActive = 0; // workers inside run_chunks
+    std::atomic<size_t> nextChunk = 0;
+    std::atomic<size_t> chunksDone = 0;
+};
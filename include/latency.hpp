@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+// Caps how many frames the driver may queue ahead of the GPU (every queued frame adds a frame of input latency).
+// A fence is inserted after every swap, once more than maxQueuedFrames are in flight the CPU waits for the oldest one.
+// With maxQueuedFrames = 0 it simply calls glFinish() after the swap.
+struct FrameQueueLimiter {
+    ~FrameQueueLimiter() {
+        reset();
+    }
+
+    void after_swap() {
+        if (maxQueuedFrames == 0) {
+            glFinish();
+            return;
+        }
+
+        fences[(first + count) % fences.size()] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, UnusedMask::GL_UNUSED_BIT);
+        count++;
+        while (count > std::min<size_t>(maxQueuedFrames, fences.size() - 1)) {
+            glClientWaitSync(fences[first], SyncObjectMask::GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms timeout
+            glDeleteSync(fences[first]);
+            first = (first + 1) % fences.size();
+            count--;
+        }
+    }
+
+    // drop all pending fences (e.g. when the limiter gets disabled)
+    void reset() {
+        for (; count > 0; count--) {
+            glDeleteSync(fences[first]);
+            first = (first + 1) % fences.size();
+        }
+    }
+
+    size_t maxQueuedFrames = 1;
+
+private:
+    std::array<GLsync, 4> fences;
+    size_t first = 0;
+    size_t count = 0;
+};
+
+// Measures the time from the newest input event that went into a frame until the frame was swapped
+struct LatencyProbe {
+    // both timestamps in SDL nanoseconds, frames without new input are ignored
+    void record(uint64_t eventTimestamp, uint64_t swapTimestamp) {
+        if (eventTimestamp == 0 || eventTimestamp <= lastEventTimestamp) return;
+        lastEventTimestamp = eventTimestamp;
+
+        float latency = (float)(swapTimestamp - eventTimestamp) * 0.000001f; // ns to ms
+        lastMs = latency;
+        minMs = std::min(minMs, latency);
+        maxMs = std::max(maxMs, latency);
+        sumMs += latency;
+        nSamples++;
+    }
+
+    // print and restart the statistics every interval (seconds)
+    void log(uint64_t now, float interval = 5.0f) {
+        if (now - lastLog < (uint64_t)(interval * 1000000000.0f)) return;
+        lastLog = now;
+        if (nSamples == 0) return;
+
+        averageMs = sumMs / nSamples;
+        std::cout << "Input latency: " << averageMs << " ms avg, " << minMs << " ms min, " << maxMs << " ms max (" << nSamples << " samples)" << std::endl;
+        minMs = 1e9f;
+        maxMs = 0.0f;
+        sumMs = 0.0f;
+        nSamples = 0;
+    }
+
+    float lastMs = 0.0f;
+    float averageMs = 0.0f; // of the last logged interval
+
+private:
+    uint64_t lastEventTimestamp = 0;
+    uint64_t lastLog = 0;
+    float minMs = 1e9f;
+    float maxMs = 0.0f;
+    float sumMs = 0.0f;
+    int nSamples = 0;
+};
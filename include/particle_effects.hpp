@@ -0,0 +1,145 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define PARTICLES_SSE
+#endif
+
+// Kinds of particle effects spawned by gameplay events
+enum class ParticleEffect : uint32_t { eMuzzleFlash, eHit, eDeath };
+
+// A gameplay event that spawns particles, tagged with the simulation tick it happened in
+struct ParticleBurst {
+    glm::vec3 position;
+    uint32_t tick;
+    glm::vec3 direction;
+    uint32_t count;
+    ParticleEffect effect;
+};
+
+// Look of an effect, shared by the GPU and the CPU particles.
+// Colors are premultiplied, alpha 0 means purely additive (emissive particles do not need sorting).
+struct ParticleEffectParams {
+    glm::vec4 color;
+    float speed;    // initial speed along the burst direction
+    float spread;   // 0 = straight along the direction, 1 = in all directions
+    float lifetime; // seconds
+    float size;     // billboard half size in world units
+    float gravity;
+    float drag;     // velocity loss per second
+};
+
+inline const ParticleEffectParams& particle_effect_params(ParticleEffect effect) {
+    static const std::array<ParticleEffectParams, 3> params = {{
+        {glm::vec4(1.0f, 0.7f, 0.3f, 0.0f), 8.0f, 0.35f, 0.12f, 0.05f, 0.0f, 6.0f},  // muzzle flash sparks
+        {glm::vec4(0.35f, 0.02f, 0.02f, 0.8f), 3.0f, 0.6f, 0.6f, 0.06f, 9.8f, 1.0f}, // blood spray
+        {glm::vec4(0.3f, 0.02f, 0.02f, 0.9f), 4.0f, 1.0f, 1.2f, 0.1f, 9.8f, 2.0f},   // blood burst of a dying zombie
+    }};
+    return params[(size_t)effect];
+}
+
+// Integer hash for particle randomness (same function as in particle_emit.comp)
+inline uint32_t particle_hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+inline float particle_random(uint32_t& state) {
+    state = particle_hash(state);
+    return (float)(state >> 8) * (1.0f / 16777216.0f);
+}
+// initial velocity of particle i of a burst
+inline glm::vec3 particle_velocity(const ParticleBurst& burst, const ParticleEffectParams& params, uint32_t i) {
+    uint32_t state = burst.tick * 7919U + i * 104729U + (uint32_t)burst.effect;
+    // one call per statement, the evaluation order of function arguments is unspecified
+    float x = particle_random(state);
+    float y = particle_random(state);
+    float z = particle_random(state);
+    glm::vec3 random = glm::vec3(x, y, z) * 2.0f - 1.0f;
+    glm::vec3 direction = glm::normalize(burst.direction + random * params.spread * 2.0f + glm::vec3(0.0f, 0.0001f, 0.0f));
+    return direction * params.speed * (0.5f + 0.5f * particle_random(state));
+}
+
+// CPU fallback of the particle simulation (no compute shaders needed, runs headless).
+// Structure of arrays with a ring allocation like the GPU version, updated 4 particles at a time with SSE.
+struct CpuParticles {
+    CpuParticles(size_t capacity) : capacity((capacity + 3) & ~size_t(3)) {
+        for (auto* array : {&posX, &posY, &posZ, &velX, &velY, &velZ, &life, &lifetime, &gravity, &drag, &size})
+            array->resize(this->capacity, 0.0f);
+        color.resize(this->capacity);
+    }
+
+    void emit(const ParticleBurst& burst) {
+        const ParticleEffectParams& params = particle_effect_params(burst.effect);
+        for (uint32_t i = 0; i < burst.count; i++) {
+            glm::vec3 velocity = particle_velocity(burst, params, i);
+            posX[head] = burst.position.x; posY[head] = burst.position.y; posZ[head] = burst.position.z;
+            velX[head] = velocity.x; velY[head] = velocity.y; velZ[head] = velocity.z;
+            life[head] = lifetime[head] = params.lifetime;
+            gravity[head] = params.gravity;
+            drag[head] = params.drag;
+            size[head] = params.size;
+            color[head] = params.color;
+            head = (head + 1) % capacity;
+            count = std::min(count + 1, capacity);
+        }
+    }
+
+    // integrates all used slots, returns the number of particles that are still alive
+    size_t update(float dt) {
+        size_t nAlive = 0;
+        size_t n = (count + 3) & ~size_t(3); // the arrays are padded to a multiple of 4
+#ifdef PARTICLES_SSE
+        const __m128 vDt = _mm_set1_ps(dt);
+        const __m128 vZero = _mm_setzero_ps();
+        const __m128 vOne = _mm_set1_ps(1.0f);
+        for (size_t i = 0; i < n; i += 4) {
+            __m128 vLife = _mm_sub_ps(_mm_loadu_ps(&life[i]), vDt);
+            __m128 vDamping = _mm_max_ps(vZero, _mm_sub_ps(vOne, _mm_mul_ps(_mm_loadu_ps(&drag[i]), vDt)));
+            __m128 vx = _mm_mul_ps(_mm_loadu_ps(&velX[i]), vDamping);
+            __m128 vy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&velY[i]), _mm_mul_ps(_mm_loadu_ps(&gravity[i]), vDt)), vDamping);
+            __m128 vz = _mm_mul_ps(_mm_loadu_ps(&velZ[i]), vDamping);
+            _mm_storeu_ps(&posX[i], _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_mul_ps(vx, vDt)));
+            _mm_storeu_ps(&posY[i], _mm_add_ps(_mm_loadu_ps(&posY[i]), _mm_mul_ps(vy, vDt)));
+            _mm_storeu_ps(&posZ[i], _mm_add_ps(_mm_loadu_ps(&posZ[i]), _mm_mul_ps(vz, vDt)));
+            _mm_storeu_ps(&velX[i], vx);
+            _mm_storeu_ps(&velY[i], vy);
+            _mm_storeu_ps(&velZ[i], vz);
+            _mm_storeu_ps(&life[i], vLife);
+            int aliveMask = _mm_movemask_ps(_mm_cmpgt_ps(vLife, vZero));
+            nAlive += (aliveMask & 1) + ((aliveMask >> 1) & 1) + ((aliveMask >> 2) & 1) + ((aliveMask >> 3) & 1);
+        }
+#else
+        for (size_t i = 0; i < n; i++) {
+            float damping = std::max(0.0f, 1.0f - drag[i] * dt);
+            velX[i] *= damping;
+            velY[i] = (velY[i] - gravity[i] * dt) * damping;
+            velZ[i] *= damping;
+            posX[i] += velX[i] * dt;
+            posY[i] += velY[i] * dt;
+            posZ[i] += velZ[i] * dt;
+            life[i] -= dt;
+            nAlive += life[i] > 0.0f;
+        }
+#endif
+        alive = nAlive;
+        return nAlive;
+    }
+
+    size_t capacity;
+    size_t count = 0; // used slots (alive or dead)
+    size_t alive = 0;
+    size_t head = 0;  // next slot to overwrite
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> life, lifetime, gravity, drag, size;
+    std::vector<glm::vec4> color;
+};
@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <glm/glm.hpp>
+//
+#include "pipeline.hpp"
+#include "stream_buffer.hpp"
+#include "render_target.hpp"
+#include "particle_effects.hpp"
+#include "game_objects/camera.hpp"
+
+// Particle effects of gameplay events (muzzle flash, hits, deaths).
+// Particles live in a ring of slots in an SSBO and are emitted and simulated by compute shaders,
+// the CPU fallback (CpuParticles) streams its particles into the same layout every frame.
+// Drawn as instanced billboards with premultiplied alpha and a soft fade against the scene depth.
+struct ParticleSystem {
+    static constexpr uint32_t gpuCapacity = 1 << 17; // 100k+ particles, 8 MiB
+    static constexpr uint32_t cpuCapacity = 8192;    // streamed every frame, has to fit into the stream buffer
+    static constexpr uint32_t maxBursts = 256;       // per frame
+
+    ParticleSystem(bool bCpu) : bCpu(bCpu), capacity(bCpu ? cpuCapacity : gpuCapacity), cpuParticles(bCpu ? cpuCapacity : 0) {
+        if (!bCpu) {
+            glCreateBuffers(1, &particleBuffer);
+            glNamedBufferStorage(particleBuffer, capacity * sizeof(GpuParticle), nullptr, BufferStorageMask::GL_NONE_BIT);
+        }
+        glCreateVertexArrays(1, &vao); // billboards are generated from gl_VertexID/gl_InstanceID
+    }
+    ~ParticleSystem() {
+        if (particleBuffer) glDeleteBuffers(1, &particleBuffer);
+        glDeleteVertexArrays(1, &vao);
+    }
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // spawns the bursts of the snapshot that are newer than the last spawned tick (snapshots can be skipped or repeated)
+    void emit(const std::vector<ParticleBurst>& bursts, StreamBuffer& streamBuffer) {
+        newBursts.clear();
+        int64_t newestTick = lastTick;
+        for (auto& burst : bursts) {
+            if ((int64_t)burst.tick <= lastTick) continue;
+            if (newBursts.size() < maxBursts) newBursts.push_back(burst);
+            newestTick = std::max(newestTick, (int64_t)burst.tick);
+        }
+        lastTick = newestTick;
+        if (newBursts.empty()) return;
+
+        if (bCpu) {
+            for (auto& burst : newBursts)
+                cpuParticles.emit(burst);
+            return;
+        }
+
+        StreamBuffer::Allocation range = streamBuffer.allocate(newBursts.size() * sizeof(GpuBurst), streamBuffer.storage_alignment());
+        if (!range) return;
+        GpuBurst* gpuBursts = (GpuBurst*)range.data;
+        uint32_t nSpawn = 0;
+        for (size_t i = 0; i < newBursts.size(); i++) {
+            const ParticleBurst& burst = newBursts[i];
+            const ParticleEffectParams& params = particle_effect_params(burst.effect);
+            uint32_t count = std::min(burst.count, capacity - nSpawn);
+            gpuBursts[i] = {glm::vec4(burst.position, 0.0f), glm::vec4(burst.direction, 0.0f), params.color,
+                glm::vec4(params.speed, params.spread, params.lifetime, params.size), glm::vec4(params.gravity, params.drag, 0.0f, 0.0f),
+                glm::uvec4(nSpawn, count, burst.tick, (uint32_t)burst.effect)};
+            nSpawn += count;
+        }
+
+        emitPipeline.bind();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particleBuffer);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, streamBuffer.buffer, range.offset, range.size);
+        glUniform1ui(0, head);
+        glUniform1ui(1, (GLuint)newBursts.size());
+        glUniform1ui(2, nSpawn);
+        glUniform1ui(3, capacity);
+        glDispatchCompute((nSpawn + 63) / 64, 1, 1);
+        glMemoryBarrier(MemoryBarrierMask::GL_SHADER_STORAGE_BARRIER_BIT);
+        head = (head + nSpawn) % capacity;
+        count = std::min(count + nSpawn, capacity);
+    }
+
+    void update(float deltaTime) {
+        if (bCpu) {
+            cpuParticles.update(deltaTime);
+            count = (uint32_t)cpuParticles.count;
+            return;
+        }
+        if (count == 0) return;
+        updatePipeline.bind();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particleBuffer);
+        glUniform1f(0, deltaTime);
+        glUniform1ui(1, count);
+        glDispatchCompute((count + 255) / 256, 1, 1);
+        glMemoryBarrier(MemoryBarrierMask::GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // draws into the bound scene target, reads its depth for the soft fade (depth test and writes are off meanwhile)
+    void draw(Camera& camera, const RenderTarget& target, StreamBuffer& streamBuffer) {
+        if (count == 0) return;
+        GLuint buffer = particleBuffer;
+        StreamBuffer::Allocation range;
+        if (bCpu) {
+            range = streamBuffer.allocate(count * sizeof(GpuParticle), streamBuffer.storage_alignment());
+            if (!range) return;
+            GpuParticle* particles = (GpuParticle*)range.data;
+            for (uint32_t i = 0; i < count; i++) {
+                particles[i] = {glm::vec4(cpuParticles.posX[i], cpuParticles.posY[i], cpuParticles.posZ[i], cpuParticles.size[i]),
+                    glm::vec4(cpuParticles.velX[i], cpuParticles.velY[i], cpuParticles.velZ[i], cpuParticles.life[i]),
+                    cpuParticles.color[i], glm::vec4(cpuParticles.lifetime[i], cpuParticles.gravity[i], cpuParticles.drag[i], 0.0f)};
+            }
+            buffer = streamBuffer.buffer;
+        }
+
+        drawPipeline.bind();
+        camera.bind();
+        glUniform2f(20, camera.nearPlane, camera.farPlane);
+        glUniform1f(21, 0.3f);
+        if (bCpu)
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, buffer, range.offset, range.size);
+        else
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+        glBindTextureUnit(0, target.depthTexture);
+
+        glDisable(GL_DEPTH_TEST);
+        glDepthMask(false);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glBindVertexArray(vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        glBindVertexArray(0);
+        glDisable(GL_BLEND);
+        glDepthMask(true);
+        glEnable(GL_DEPTH_TEST);
+
+        RenderStats::get().counters().drawCalls++;
+        RenderStats::get().counters().triangles += 2 * count;
+    }
+
+    uint32_t get_count() const { return count; } // used slots, alive or not
+
+private:
+    struct GpuParticle {
+        glm::vec4 positionSize;
+        glm::vec4 velocityLife;
+        glm::vec4 color;
+        glm::vec4 motion;
+    };
+    struct GpuBurst {
+        glm::vec4 position;
+        glm::vec4 direction;
+        glm::vec4 color;
+        glm::vec4 shape;
+        glm::vec4 motion;
+        glm::uvec4 range;
+    };
+
+    bool bCpu;
+    uint32_t capacity;
+    uint32_t head = 0;
+    uint32_t count = 0;
+    int64_t lastTick = -1; // newest tick whose bursts were spawned
+    std::vector<ParticleBurst> newBursts;
+    CpuParticles cpuParticles;
+    GLuint particleBuffer = 0;
+    GLuint vao;
+    Pipeline emitPipeline = Pipeline({{GL_COMPUTE_SHADER, "shaders/particle_emit.comp"}});
+    Pipeline updatePipeline = Pipeline({{GL_COMPUTE_SHADER, "shaders/particle_update.comp"}});
+    Pipeline drawPipeline = Pipeline("shaders/particle.vs", "shaders/particle.fs");
+};
@@ -1,56 +1,65 @@
 #pragma once
+#include "render_stats.hpp"
+#include "shader_cache.hpp"
 
 struct Pipeline {
-    Pipeline(std::string vertex_shader_path, std::string fragment_shader_path) {
-         // compile shader at runtime
-        const GLchar* vertexShaderString = load_shader(vertex_shader_path);
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderString, nullptr);
-        glCompileShader(vertexShader);
-
-        // check results
-        GLint success;
-        std::vector<GLchar> infoLog(512);
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(vertexShader, infoLog.size(), nullptr, infoLog.data());
-            std::cout << infoLog.data() << "\n";
-        }
-
-        // now we do the same for pixel/fragment shader
-        const GLchar* fragmentShaderString = load_shader(fragment_shader_path);
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderString, nullptr);
-        glCompileShader(fragmentShader);
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragmentShader, infoLog.size(), nullptr, infoLog.data());
-            std::cout << infoLog.data() << "\n";
-        }
-
-        // to combine all shader stages, we create a shader program
-        shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vertexShader);
-        glAttachShader(shaderProgram, fragmentShader);
-        glLinkProgram(shaderProgram);
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(shaderProgram, infoLog.size(), nullptr, infoLog.data());
-            std::cout << infoLog.data() << "\n";
-        }
-        glDeleteShader(vertexShader); // can safely delete after linking
-        glDeleteShader(fragmentShader); // can safely delete after linking
+    // defines select a permutation of the shaders, e.g. {"SHADOW_QUALITY 1"}
+    Pipeline(std::string vertex_shader_path, std::string fragment_shader_path, std::vector<std::string> defines = {})
+        : stages({{GL_VERTEX_SHADER, vertex_shader_path}, {GL_FRAGMENT_SHADER, fragment_shader_path}}), defines(defines) {
+        // compiled at runtime (or loaded from the program binary cache)
+        shaderProgram = ShaderCache::get().load(stages, defines);
+        generation = ShaderCache::get().get_generation();
+    }
+    // any combination of stages, e.g. a single compute shader: Pipeline({{GL_COMPUTE_SHADER, "shaders/x.comp"}})
+    Pipeline(std::vector<ShaderCache::Stage> stages, std::vector<std::string> defines = {})
+        : stages(stages), defines(defines) {
+        shaderProgram = ShaderCache::get().load(stages, defines);
+        generation = ShaderCache::get().get_generation();
     }
     ~Pipeline() {
-        glDeleteProgram(shaderProgram);
+        if (shaderProgram) glDeleteProgram(shaderProgram);
+    }
+    // owns its program: moved, never copied
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+    Pipeline(Pipeline&& other) noexcept
+        : framebuffer(other.framebuffer), framebufferTexture(other.framebufferTexture), stages(std::move(other.stages)),
+          defines(std::move(other.defines)), generation(other.generation), shaderProgram(other.shaderProgram) {
+        other.shaderProgram = 0;
+    }
+    Pipeline& operator=(Pipeline&& other) noexcept {
+        // the other one deletes our old program
+        std::swap(framebuffer, other.framebuffer);
+        std::swap(framebufferTexture, other.framebufferTexture);
+        std::swap(stages, other.stages);
+        std::swap(defines, other.defines);
+        std::swap(generation, other.generation);
+        std::swap(shaderProgram, other.shaderProgram);
+        return *this;
     }
 
     void bind() {
+#ifdef SHADER_HOT_RELOAD
+        if (generation != ShaderCache::get().get_generation()) reload();
+#endif
         glUseProgram(shaderProgram);
+        RenderStats::get().counters().pipelineBinds++;
     }
 
-    GLuint framebuffer;
-    GLuint framebufferTexture;
+    GLuint framebuffer = 0;
+    GLuint framebufferTexture = 0;
 private:
+    // keeps the old program if the new sources do not compile
+    void reload() {
+        generation = ShaderCache::get().get_generation();
+        if (GLuint program = ShaderCache::get().load(stages, defines)) {
+            glDeleteProgram(shaderProgram);
+            shaderProgram = program;
+        }
+    }
+
+    std::vector<ShaderCache::Stage> stages;
+    std::vector<std::string> defines;
+    uint32_t generation;
     GLuint shaderProgram;
-};
\ No newline at end of file
+};
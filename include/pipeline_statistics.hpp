@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+#include <cstring>
+#include <cstdint>
+//
+#include "render_stats.hpp"
+
+// Pipeline statistics queries (core in 4.6, GL_ARB_pipeline_statistics_query before) of a pass.
+// One query per counter and frame in flight, results are read back a few frames later like the GpuTimer.
+struct PipelineStatisticsQuery {
+    static bool supported() {
+        static bool bSupported = [] {
+            GLint major = 0, minor = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &major);
+            glGetIntegerv(GL_MINOR_VERSION, &minor);
+            if (major > 4 || (major == 4 && minor >= 6)) return true;
+
+            GLint nExtensions = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &nExtensions);
+            for (GLint i = 0; i < nExtensions; i++) {
+                auto extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+                if (extension && std::strcmp(extension, "GL_ARB_pipeline_statistics_query") == 0) return true;
+            }
+            return false;
+        }();
+        return bSupported;
+    }
+
+    PipelineStatisticsQuery() {
+        if (!supported()) return;
+        for (size_t i = 0; i < targets.size(); i++)
+            glCreateQueries(targets[i], (GLsizei)nFrames, queries[i].data());
+    }
+    ~PipelineStatisticsQuery() {
+        if (!supported()) return;
+        for (auto& frameQueries : queries)
+            glDeleteQueries((GLsizei)nFrames, frameQueries.data());
+    }
+    PipelineStatisticsQuery(const PipelineStatisticsQuery&) = delete;
+    PipelineStatisticsQuery& operator=(const PipelineStatisticsQuery&) = delete;
+
+    void begin() {
+        if (!supported()) return;
+        collect();
+        for (size_t i = 0; i < targets.size(); i++)
+            glBeginQuery(targets[i], queries[i][index]);
+    }
+    void end() {
+        if (!supported()) return;
+        for (size_t i = 0; i < targets.size(); i++)
+            glEndQuery(targets[i]);
+        bPending[index] = true;
+        index = (index + 1) % nFrames;
+    }
+
+    PipelineCounts last;  // newest available result
+    PipelineCounts total; // sum of all results
+    uint64_t nSamples = 0;
+
+private:
+    void collect() {
+        if (!bPending[index]) return;
+        std::array<GLuint64, 5> values;
+        for (size_t i = 0; i < targets.size(); i++)
+            glGetQueryObjectui64v(queries[i][index], GL_QUERY_RESULT, &values[i]);
+        bPending[index] = false;
+
+        last = { values[0], values[1], values[2], values[3], values[4] };
+        total.verticesSubmitted += last.verticesSubmitted;
+        total.primitivesSubmitted += last.primitivesSubmitted;
+        total.vertexInvocations += last.vertexInvocations;
+        total.fragmentInvocations += last.fragmentInvocations;
+        total.clippingOutput += last.clippingOutput;
+        nSamples++;
+    }
+
+    static constexpr size_t nFrames = 4;
+    static constexpr std::array<GLenum, 5> targets = {
+        GL_VERTICES_SUBMITTED, GL_PRIMITIVES_SUBMITTED, GL_VERTEX_SHADER_INVOCATIONS, GL_FRAGMENT_SHADER_INVOCATIONS, GL_CLIPPING_OUTPUT_PRIMITIVES
+    };
+    std::array<std::array<GLuint, nFrames>, 5> queries;
+    std::array<bool, nFrames> bPending = {};
+    size_t index = 0;
+};
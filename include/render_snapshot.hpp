@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "game_objects/transform.hpp"
+#include "particle_effects.hpp"
+
+// Copy of everything the render thread needs for one frame, filled by the simulation thread once per tick.
+// The render thread only reads it, so enemies and projectiles can be spawned/deleted while a frame is drawn.
+struct RenderSnapshot {
+    enum class Screen { eStart, eGame, eEnd };
+    struct LightState {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+    struct EnemyAnimation {
+        float time = 0.0f;       // seconds, offset per zombie
+        float walkWeight = 0.0f; // blend from idle (0) to walk (1)
+    };
+    // unshadowed light for the clustered lighting
+    struct PointLightState {
+        glm::vec3 position;
+        float radius;
+        glm::vec3 color;
+    };
+
+    Screen screen = Screen::eStart;
+    bool bMouseCaptured = false;
+    bool bWireframe = false;
+    bool bLowLatency = false;
+    bool bDepthPrepass = true;
+    float renderScale = 1.0f;
+    bool bDynamicResolution = false;
+    float targetFps = 0.0f; // frame limiter, 0 = off
+    uint32_t glTraceRequests = 0; // a new GL trace starts whenever this changes
+
+    // camera
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    glm::vec3 cameraRotation = glm::vec3(0.0f);
+    float lookSpeed = 0.0f; // rotation per mouse delta, for late-latching
+    uint64_t inputTimestamp = 0; // newest input event that went into this tick
+    float time = 0.0f; // simulation time in seconds
+
+    // instances (vectors keep their capacity between ticks, so steady state does not allocate)
+    Transform weapon;
+    std::vector<Transform> enemies;
+    std::vector<EnemyAnimation> enemyAnimations; // parallel to enemies
+    std::vector<Transform> projectiles;
+    std::vector<LightState> lights; // shadow casters
+    std::vector<PointLightState> pointLights;
+    std::vector<ParticleBurst> particleBursts; // of the last few ticks, the renderer spawns each tick once
+
+    // ui values
+    float health = 0.0f;
+    float stamina = 0.0f;
+    unsigned int bullets = 0;
+    unsigned int magazine = 0;
+    size_t zombiesLeft = 0;
+    int zombiesKilled = 0;
+    int wave = 0;
+
+    // stats
+    size_t crowdAgents = 0;
+    float crowdUpdateMs = 0.0f;
+    uint64_t simulationAllocations = 0; // heap allocations during the tick (debug builds only)
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Workload counters of the render thread, accumulated per pass and reset at the start of every frame
+struct RenderStats {
+    enum class Pass : uint8_t { eShadow, eSkybox, eDepth, eColor, eParticles, eUpscale, eUI };
+    static constexpr size_t nPasses = 7;
+    static constexpr std::array<const char*, nPasses> passNames = { "shadow", "skybox", "depth", "color", "particles", "upscale", "ui" };
+
+    struct Counters {
+        uint64_t drawCalls = 0;
+        uint64_t triangles = 0;
+        uint64_t pipelineBinds = 0;  // program changes
+        uint64_t materialBinds = 0;  // material uniforms + texture binds
+        uint64_t transformBinds = 0; // model/normal matrix uploads
+
+        Counters& operator+=(const Counters& other) noexcept {
+            drawCalls += other.drawCalls;
+            triangles += other.triangles;
+            pipelineBinds += other.pipelineBinds;
+            materialBinds += other.materialBinds;
+            transformBinds += other.transformBinds;
+            return *this;
+        }
+    };
+
+    static RenderStats& get() noexcept { static RenderStats instance; return instance; }
+
+    void reset() noexcept {
+        passes.fill({});
+        current = Pass::eColor;
+        shadowFaces = 0;
+    }
+
+    // everything counted from now on belongs to this pass
+    void begin_pass(Pass pass) noexcept {
+        current = pass;
+    }
+    Counters& counters() noexcept {
+        return passes[(size_t)current];
+    }
+    Counters total() const noexcept {
+        Counters result;
+        for (auto& pass : passes) result += pass;
+        return result;
+    }
+
+    std::array<Counters, nPasses> passes;
+    Pass current = Pass::eColor;
+    uint64_t shadowFaces = 0; // cubemap faces rendered in the shadow pass
+};
+
+// GPU side counts of a pass from pipeline statistics queries
+struct PipelineCounts {
+    uint64_t verticesSubmitted = 0;
+    uint64_t primitivesSubmitted = 0;
+    uint64_t vertexInvocations = 0;
+    uint64_t fragmentInvocations = 0;
+    uint64_t clippingOutput = 0; // primitives that survived clipping
+};
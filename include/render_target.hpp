@@ -0,0 +1,46 @@
+#pragma once
+#include <algorithm>
+#include <iostream>
+
+// Offscreen HDR color + depth target for the 3D passes.
+// Allocated once at native size, a lower render scale only uses the bottom left part of it (no reallocation on scale changes).
+struct RenderTarget {
+    RenderTarget(int width, int height) : width(width), height(height) {
+        glCreateTextures(GL_TEXTURE_2D, 1, &colorTexture);
+        glTextureStorage2D(colorTexture, 1, GL_RGBA16F, width, height);
+        glTextureParameteri(colorTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(colorTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(colorTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(colorTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glCreateTextures(GL_TEXTURE_2D, 1, &depthTexture);
+        glTextureStorage2D(depthTexture, 1, GL_DEPTH_COMPONENT32F, width, height);
+
+        glCreateFramebuffers(1, &framebuffer);
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, colorTexture, 0);
+        glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, depthTexture, 0);
+        if (glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Render target " << width << "x" << height << " is incomplete" << std::endl;
+    }
+    ~RenderTarget() {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &colorTexture);
+        glDeleteTextures(1, &depthTexture);
+    }
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    // binds the target and sets the viewport to the scaled resolution
+    void bind(float scale) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, scaled_width(scale), scaled_height(scale));
+    }
+
+    int scaled_width(float scale) const { return std::max(1, (int)(width * scale)); }
+    int scaled_height(float scale) const { return std::max(1, (int)(height * scale)); }
+
+    int width;
+    int height;
+    GLuint framebuffer;
+    GLuint colorTexture;
+    GLuint depthTexture;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+//
+#include "pipeline.hpp"
+#include "render_target.hpp"
+
+// Picks the render scale from the measured GPU frame time.
+// The GPU times arrive a few frames late, so the scale only changes every few frames and within a dead band.
+struct DynamicResolution {
+    static constexpr float minScale = 0.5f;
+    static constexpr float maxScale = 1.0f;
+
+    // gpuMs: GPU time of the 3D passes, budgetMs: frame time that should be reached
+    float update(float gpuMs, float budgetMs) {
+        if (gpuMs <= 0.0f)
+            return scale;
+        averageMs = averageMs > 0.0f ? averageMs * 0.9f + gpuMs * 0.1f : gpuMs;
+        if (cooldown > 0) {
+            cooldown--;
+            return scale;
+        }
+        // keep some headroom, only react outside of [75%, 95%] of the budget
+        if (averageMs > budgetMs * 0.95f || averageMs < budgetMs * 0.75f) {
+            // the shading cost grows with the pixel count, i.e. with scale^2
+            float target = scale * std::sqrt(budgetMs * 0.85f / averageMs);
+            target = std::clamp(target, scale - 0.1f, scale + 0.05f);
+            target = std::round(target * 40.0f) / 40.0f; // 2.5% steps
+            if (target != scale) {
+                scale = std::clamp(target, minScale, maxScale);
+                averageMs = 0.0f;
+                cooldown = 8;
+            }
+        }
+        return scale;
+    }
+
+    float scale = maxScale;
+
+private:
+    float averageMs = 0.0f;
+    int cooldown = 0;
+};
+
+// Upscales the used part of a render target to the backbuffer with a contrast adaptive sharpening filter
+struct Upscaler {
+    Upscaler() {
+        glCreateVertexArrays(1, &vao); // the fullscreen triangle is generated from gl_VertexID
+    }
+    ~Upscaler() {
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    // draws into the currently bound framebuffer (viewport has to be set to its full size)
+    void draw(const RenderTarget& source, float scale, float sharpness) {
+        pipeline.bind();
+        glBindTextureUnit(0, source.colorTexture);
+        glUniform2f(0, (float)source.scaled_width(scale) / source.width, (float)source.scaled_height(scale) / source.height);
+        glUniform2f(1, 1.0f / source.width, 1.0f / source.height);
+        glUniform1f(2, sharpness);
+        glDisable(GL_DEPTH_TEST);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glEnable(GL_DEPTH_TEST);
+        RenderStats::get().counters().drawCalls++;
+        RenderStats::get().counters().triangles++;
+    }
+
+private:
+    Pipeline pipeline = Pipeline("shaders/upscale.vs", "shaders/upscale.fs");
+    GLuint vao;
+};
@@ -0,0 +1,240 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+//
+#include "utils.hpp"
+
+// Dev builds read shaders from the source tree (instead of the embedded copies) and reload them when they change
+#if !defined(NDEBUG) && defined(DEV_SOURCE_DIR)
+    #define SHADER_HOT_RELOAD
+#endif
+
+// Builds shader programs from the embedded sources plus #define permutations.
+// Linked programs are stored on disk with glGetProgramBinary, keyed by sources, defines and driver,
+// so later launches skip compilation (and fall back to it whenever a binary is rejected).
+struct ShaderCache {
+    struct Stage {
+        GLenum type; // GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER, ...
+        std::string path;
+    };
+
+    static ShaderCache& get() {
+        static ShaderCache instance;
+        return instance;
+    }
+
+    // returns 0 if compilation or linking failed
+    GLuint load(const std::vector<Stage>& stages, const std::vector<std::string>& defines) {
+        // gather sources, the defines go right behind the #version line
+        std::vector<std::string> sources;
+        uint64_t key = hash(driver);
+        for (auto& stage : stages) {
+            sources.push_back(inject_defines(read_source(stage.path), defines));
+            key = hash(sources.back(), key);
+        }
+
+        std::string binaryPath = cacheDir + "/" + to_hex(key) + ".bin";
+        if (GLuint program = load_binary(binaryPath)) return program;
+
+        GLuint program = compile(stages, sources);
+        if (program) store_binary(program, binaryPath);
+        return program;
+    }
+
+    // changes whenever a shader source changed on disk (pipelines reload themselves once they see a new generation)
+    uint32_t get_generation() const {
+        return generation;
+    }
+
+    // checks the shader sources for changes, called once per frame (does nothing in release builds)
+    void poll() {
+#ifdef SHADER_HOT_RELOAD
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPoll < std::chrono::milliseconds(500)) return;
+        lastPoll = now;
+
+        for (auto& [path, writeTime] : watchedFiles) {
+            std::error_code error;
+            auto currentTime = std::filesystem::last_write_time(path, error);
+            if (!error && currentTime != writeTime) {
+                writeTime = currentTime;
+                generation++;
+                std::cout << "Reloading shaders, " << path << " changed" << std::endl;
+            }
+        }
+#endif
+    }
+
+    // cache file layout: binary format, then the program binary (no GL calls)
+    static bool write_binary_file(const std::string& path, GLenum format, const std::vector<char>& binary) {
+        std::ofstream file(path, std::ios::binary);
+        file.write((const char*)&format, sizeof(format));
+        file.write(binary.data(), binary.size());
+        return file.good();
+    }
+    static bool read_binary_file(const std::string& path, GLenum& format, std::vector<char>& binary) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        std::streamoff size = file.tellg();
+        if (size <= (std::streamoff)sizeof(format)) return false;
+        file.seekg(0);
+        file.read((char*)&format, sizeof(format));
+        binary.resize((size_t)(size - (std::streamoff)sizeof(format)));
+        file.read(binary.data(), binary.size());
+        return file.good() && file.gcount() == (std::streamsize)binary.size();
+    }
+
+private:
+    ShaderCache() {
+        // binaries are only valid for the driver that created them
+        driver = std::string((const char*)glGetString(GL_VENDOR)) + (const char*)glGetString(GL_RENDERER) + (const char*)glGetString(GL_VERSION);
+        GLint nFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+        bBinariesSupported = nFormats > 0;
+        if (bBinariesSupported) std::filesystem::create_directories(cacheDir);
+    }
+
+    std::string read_source(const std::string& path) {
+#ifdef SHADER_HOT_RELOAD
+        std::string diskPath = std::string(DEV_SOURCE_DIR) + path;
+        std::ifstream file(diskPath);
+        if (file) {
+            std::error_code error;
+            watchedFiles.emplace(diskPath, std::filesystem::last_write_time(diskPath, error));
+            std::stringstream stream;
+            stream << file.rdbuf();
+            return stream.str();
+        }
+#endif
+        auto fs = cmrc::shaders::get_filesystem();
+        if (!fs.exists(path)) {
+            std::cerr << "Unable to load shader: " << path << std::endl;
+            return {};
+        }
+        auto file = fs.open(path);
+        return std::string(file.begin(), file.end());
+    }
+
+    static std::string inject_defines(const std::string& source, const std::vector<std::string>& defines) {
+        if (defines.empty()) return source;
+        size_t lineEnd = source.find('\n');
+        if (lineEnd == std::string::npos) return source;
+
+        std::string result = source.substr(0, lineEnd + 1);
+        for (auto& define : defines)
+            result += "#define " + define + "\n";
+        result += "#line 2\n"; // keep the line numbers of compile errors intact
+        result += source.substr(lineEnd + 1);
+        return result;
+    }
+
+    static GLuint compile(const std::vector<Stage>& stages, const std::vector<std::string>& sources) {
+        GLuint program = glCreateProgram();
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, 1); // GL_TRUE
+
+        std::vector<GLuint> shaders;
+        bool bSuccess = true;
+        for (size_t i = 0; i < stages.size(); i++) {
+            const GLchar* source = sources[i].c_str();
+            GLuint shader = glCreateShader(stages[i].type);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+
+            GLint success;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                GLint logLength = 0;
+                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+                std::vector<GLchar> infoLog(logLength + 1);
+                glGetShaderInfoLog(shader, (GLsizei)infoLog.size(), nullptr, infoLog.data());
+                std::cout << stages[i].path << ":\n" << infoLog.data() << "\n";
+                bSuccess = false;
+            }
+            glAttachShader(program, shader);
+            shaders.push_back(shader);
+        }
+
+        // to combine all shader stages, we link them into one program
+        if (bSuccess) {
+            glLinkProgram(program);
+            GLint success;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (!success) {
+                GLint logLength = 0;
+                glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+                std::vector<GLchar> infoLog(logLength + 1);
+                glGetProgramInfoLog(program, (GLsizei)infoLog.size(), nullptr, infoLog.data());
+                std::cout << infoLog.data() << "\n";
+                bSuccess = false;
+            }
+        }
+        for (GLuint shader : shaders)
+            glDeleteShader(shader); // can safely delete after linking
+
+        if (!bSuccess) {
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    GLuint load_binary(const std::string& path) {
+        if (!bBinariesSupported) return 0;
+        GLenum format;
+        std::vector<char> binary;
+        if (!read_binary_file(path, format, binary)) return 0;
+
+        // the driver may still reject it (e.g. after an update that did not change the version string)
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, format, binary.data(), (GLsizei)binary.size());
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    void store_binary(GLuint program, const std::string& path) {
+        if (!bBinariesSupported) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+
+        std::vector<char> binary(length);
+        GLenum format;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+        write_binary_file(path, format, binary);
+    }
+
+    // FNV-1a
+    static uint64_t hash(const std::string& data, uint64_t value = 14695981039346656037ull) {
+        for (unsigned char c : data) {
+            value ^= c;
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+    static std::string to_hex(uint64_t value) {
+        std::stringstream stream;
+        stream << std::hex << value;
+        return stream.str();
+    }
+
+    std::string cacheDir = "shader_cache";
+    std::string driver;
+    bool bBinariesSupported = false;
+    uint32_t generation = 0;
+#ifdef SHADER_HOT_RELOAD
+    std::unordered_map<std::string, std::filesystem::file_time_type> watchedFiles;
+    std::chrono::steady_clock::time_point lastPoll = std::chrono::steady_clock::now();
+#endif
+};
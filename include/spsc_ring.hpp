@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstddef>
+
+// Lock-free ring buffer for exactly one producer and one consumer thread (Capacity has to be a power of two)
+template<typename T, size_t Capacity>
+struct SpscRing {
+	static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity needs to be a power of two");
+
+	// producer: false if the ring is full
+	bool push(const T& item) noexcept {
+		size_t tail = tailIndex.load(std::memory_order_relaxed);
+		if (tail - headIndex.load(std::memory_order_acquire) == Capacity) return false;
+		slots[tail & (Capacity - 1)] = item;
+		tailIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+	// consumer: oldest item or nullptr if the ring is empty
+	const T* peek() noexcept {
+		size_t head = headIndex.load(std::memory_order_relaxed);
+		if (head == tailIndex.load(std::memory_order_acquire)) return nullptr;
+		return &slots[head & (Capacity - 1)];
+	}
+	// consumer: drop the item returned by peek()
+	void pop() noexcept {
+		headIndex.store(headIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+private:
+	std::array<T, Capacity> slots;
+	alignas(64) std::atomic<size_t> headIndex = 0; // written by the consumer
+	alignas(64) std::atomic<size_t> tailIndex = 0; // written by the producer
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+// Persistently and coherently mapped ring buffer for data that changes every frame (instance data, lights, debug geometry, ...).
+// The buffer is split into one region per frame in flight. A fence guards each region, so writing never stalls
+// unless the GPU is more than nFrames behind, and nothing goes through glBufferSubData.
+struct StreamBuffer {
+    static constexpr size_t nFrames = 3;
+
+    // a range of the current frame, valid until the end of the frame
+    struct Allocation {
+        void* data = nullptr; // write-only, coherent mapping
+        GLintptr offset = 0;  // in the buffer, for glBindBufferRange and vertex/index offsets
+        GLsizeiptr size = 0;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    StreamBuffer(size_t frameSize) : frameSize(frameSize) {
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        uniformAlignment = (size_t)alignment;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        storageAlignment = (size_t)alignment;
+
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, frameSize * nFrames, nullptr,
+            BufferStorageMask::GL_MAP_WRITE_BIT | BufferStorageMask::GL_MAP_PERSISTENT_BIT | BufferStorageMask::GL_MAP_COHERENT_BIT);
+        mapping = (uint8_t*)glMapNamedBufferRange(buffer, 0, frameSize * nFrames,
+            MapBufferAccessMask::GL_MAP_WRITE_BIT | MapBufferAccessMask::GL_MAP_PERSISTENT_BIT | MapBufferAccessMask::GL_MAP_COHERENT_BIT);
+    }
+    ~StreamBuffer() {
+        for (auto& fence : fences)
+            if (fence) glDeleteSync(fence);
+        glUnmapNamedBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+    }
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // switches to the next region, waits if the GPU still reads from it (nFrames ago)
+    void begin_frame() {
+        region = (region + 1) % nFrames;
+        head = 0;
+        if (fences[region]) {
+            // never write before the GPU is done with the region, a timeout only gets reported
+            GLenum result;
+            while ((result = glClientWaitSync(fences[region], SyncObjectMask::GL_SYNC_FLUSH_COMMANDS_BIT, 100000000)) == GL_TIMEOUT_EXPIRED) // 100 ms
+                std::cerr << "Stream buffer: still waiting for the GPU to release frame region " << region << std::endl;
+            if (result == GL_WAIT_FAILED) {
+                std::cerr << "Stream buffer: waiting for the fence failed, finishing all GL commands" << std::endl;
+                glFinish();
+            }
+            glDeleteSync(fences[region]);
+            fences[region] = nullptr;
+        }
+    }
+    // after all draws that read the allocations of this frame
+    void end_frame() {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, UnusedMask::GL_UNUSED_BIT);
+        peakUsage = std::max(peakUsage, head);
+    }
+
+    // alignment: 1 for vertex data, uniform_alignment() or storage_alignment() for buffer bindings
+    Allocation allocate(size_t size, size_t alignment = 16) {
+        size_t start = (head + alignment - 1) / alignment * alignment;
+        if (start + size > frameSize) {
+            if (!bOverflowReported)
+                std::cerr << "Stream buffer overflow, " << frameSize << " bytes per frame are not enough" << std::endl;
+            bOverflowReported = true;
+            return {};
+        }
+        head = start + size;
+        size_t offset = region * frameSize + start;
+        return {mapping + offset, (GLintptr)offset, (GLsizeiptr)size};
+    }
+    // copies count elements into a new allocation
+    template<typename T>
+    Allocation push(const T* data, size_t count, size_t alignment = 16) {
+        Allocation allocation = allocate(sizeof(T) * count, alignment);
+        if (allocation)
+            std::memcpy(allocation.data, data, sizeof(T) * count);
+        return allocation;
+    }
+
+    size_t uniform_alignment() const { return uniformAlignment; }
+    size_t storage_alignment() const { return storageAlignment; }
+    size_t get_peak_usage() const { return peakUsage; } // bytes of the fullest frame
+
+    GLuint buffer;
+
+private:
+    size_t frameSize;
+    uint8_t* mapping = nullptr;
+    std::array<GLsync, nFrames> fences = {};
+    size_t region = 0;
+    size_t head = 0;
+    size_t peakUsage = 0;
+    size_t uniformAlignment = 256;
+    size_t storageAlignment = 256;
+    bool bOverflowReported = false;
+};
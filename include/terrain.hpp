@@ -1,11 +1,15 @@
 #pragma once
+#include "heightfield.hpp"
 
-// Automatically creates a limited play area in which you can only move and spawns a wall around it
+// Automatically creates a limited play area in which you can only move and spawns a wall around it.
+// The ground is the heightfield, flat in the middle and hilly outside of it (rendered by TerrainChunks).
 struct Terrain
 {
     Terrain(int areaSizeX, int areaSizeZ)
         : areaSizeX(areaSizeX), areaSizeZ(areaSizeZ) {
-            spawnWalls();
+            // bigger arenas end in the hills, a straight wall would cut through them
+            if (areaSizeX <= heightfield.flatExtent && areaSizeZ <= heightfield.flatExtent)
+                spawnWalls();
         }
 
     // Limits the range
@@ -20,17 +24,26 @@ struct Terrain
         return true;
     }
 
+    // Corners of the walkable area on the xz plane
+    glm::vec3 getMinBounds() const { return glm::vec3(-areaSizeX + offset, 0, -areaSizeZ + offset); }
+    glm::vec3 getMaxBounds() const { return glm::vec3(areaSizeX - offset, 0, areaSizeZ - offset); }
+    // Corners including the walls (the obstacle grid of the pathfinding has to cover them)
+    glm::vec3 getOuterMinBounds() const { return glm::vec3(-areaSizeX - 1, 0, -areaSizeZ - 1); }
+    glm::vec3 getOuterMaxBounds() const { return glm::vec3(areaSizeX + 1, 0, areaSizeZ + 1); }
+
+    // Ground height below a position (collision of the player and zombies)
+    float height(glm::vec3 position) const { return heightfield.height(position); }
+
     std::list<Model> walls;
+    Heightfield heightfield;
 
 private:
     // Spawns walls and adds them to the list
     void spawnWalls() {
         for (int i = -1; i <= 1; i = i + 2) {
-            Model firstNewWall = Model({areaSizeX * i, 0, 0}, {0, 0, 0}, {1, 5, areaSizeX}, "models/wall/cube.obj");
-            walls.push_back(firstNewWall);
-
-            Model secondNewWall = Model({0, 0, areaSizeZ * i}, {0, 0, 0}, {areaSizeZ, 5, 1}, "models/wall/cube.obj");
-            walls.push_back(secondNewWall);
+            // built in place, a copied Model would share (and delete twice) the GL objects of its meshes
+            walls.emplace_back(glm::vec3(areaSizeX * i, 0, 0), glm::vec3(0, 0, 0), glm::vec3(1, 5, areaSizeX), "models/wall/cube.obj");
+            walls.emplace_back(glm::vec3(0, 0, areaSizeZ * i), glm::vec3(0, 0, 0), glm::vec3(areaSizeZ, 5, 1), "models/wall/cube.obj");
         }
     }
 
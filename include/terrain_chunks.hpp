@@ -0,0 +1,337 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <deque>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdint>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <stb_image.h>
+//
+#include "heightfield.hpp"
+#include "game_objects/model.hpp"
+#include "game_objects/camera.hpp"
+
+// Terrain mesh of the heightfield, streamed in square chunks around the camera (render thread).
+// A worker thread generates the vertices of missing chunks, the render thread uploads a few per frame into a fixed
+// pool of slots in one vertex buffer, so memory does not grow with the arena. Chunks are drawn with the index buffer
+// of their LOD (geomipmapping: every LOD skips every second vertex of the one before) chosen by distance,
+// the cracks between neighbouring LODs are hidden by skirts hanging down from the chunk borders.
+struct TerrainChunks {
+    static constexpr uint32_t chunkQuads = 32;                               // grid cells per chunk side at LOD 0
+    static constexpr uint32_t rowVertices = chunkQuads + 1;
+    static constexpr uint32_t gridVertices = rowVertices * rowVertices;
+    static constexpr uint32_t chunkVertices = gridVertices + 4 * rowVertices; // grid and the four skirts
+    static constexpr uint32_t nLods = 4;
+    static constexpr uint32_t capacity = 112;           // resident chunks
+    static constexpr float streamRadius = 128.0f;       // meters, beyond the far plane of the camera
+    static constexpr float lodDistance = 24.0f;         // LOD 1 starts here, each further LOD at twice the distance
+    static constexpr float skirtDepth = 2.0f;           // meters
+    static constexpr uint32_t maxUploadsPerFrame = 4;
+    static constexpr uint32_t maxPending = 16;          // chunks queued for or in generation
+
+    TerrainChunks(const Heightfield& heightfield) : heightfield(heightfield) {
+        chunkSize = chunkQuads * heightfield.spacing;
+        glCreateBuffers(1, &vbo);
+        glNamedBufferStorage(vbo, (GLsizeiptr)capacity * chunkVertices * sizeof(Vertex), nullptr, BufferStorageMask::GL_DYNAMIC_STORAGE_BIT);
+        create_indices();
+        describe_layout();
+        load_material();
+        worker = std::thread([this] { work(); });
+    }
+    ~TerrainChunks() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bStop = true;
+        }
+        wake.notify_all();
+        worker.join();
+        GLuint buffers[] = { vbo, ebo };
+        glDeleteBuffers(2, buffers);
+        glDeleteVertexArrays(1, &vao);
+        if (material.diffuseBlend > 0.0f) glDeleteTextures(1, &material.diffuseTexture);
+    }
+    TerrainChunks(const TerrainChunks&) = delete;
+    TerrainChunks& operator=(const TerrainChunks&) = delete;
+
+    // uploads generated chunks, evicts far ones and queues the missing chunks around the view, nearest first
+    void update(glm::vec3 viewPosition) {
+        glm::vec2 view = glm::vec2(viewPosition.x, viewPosition.z);
+        float keepRadius = streamRadius + chunkSize; // hysteresis, chunks at the border are not streamed in and out
+
+        for (Slot& slot : slots)
+            if (slot.bUsed && chunk_distance(slot.coord, view) > keepRadius) slot.bUsed = false;
+
+        arrived.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (!finished.empty() && arrived.size() < maxUploadsPerFrame) {
+                arrived.push_back(std::move(finished.front()));
+                finished.pop_front();
+            }
+        }
+        for (GeneratedChunk& chunk : arrived) {
+            pending.erase(std::find(pending.begin(), pending.end(), chunk.coord));
+            if (chunk_distance(chunk.coord, view) > keepRadius) continue; // the camera moved on
+            int slot = free_slot(view);
+            if (slot < 0) continue;
+            glNamedBufferSubData(vbo, (GLintptr)slot * chunkVertices * sizeof(Vertex), chunkVertices * sizeof(Vertex), chunk.vertices.data());
+            slots[slot] = { chunk.coord, chunk.minHeight, chunk.maxHeight, true };
+        }
+
+        // missing chunks in range
+        missing.clear();
+        int range = (int)std::ceil(streamRadius / chunkSize);
+        glm::ivec2 center = glm::ivec2(glm::floor(view / chunkSize));
+        for (int z = center.y - range; z <= center.y + range; z++) {
+            for (int x = center.x - range; x <= center.x + range; x++) {
+                glm::ivec2 coord = glm::ivec2(x, z);
+                if (chunk_distance(coord, view) > streamRadius || find_slot(coord) >= 0) continue;
+                if (std::find(pending.begin(), pending.end(), coord) != pending.end()) continue;
+                missing.push_back(coord);
+            }
+        }
+        std::sort(missing.begin(), missing.end(), [&](glm::ivec2 a, glm::ivec2 b) { return chunk_distance(a, view) < chunk_distance(b, view); });
+        size_t nRequests = std::min(missing.size(), (size_t)maxPending - pending.size());
+        if (nRequests > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < nRequests; i++) {
+                requests.push_back(missing[i]);
+                pending.push_back(missing[i]);
+            }
+        }
+        if (nRequests > 0) wake.notify_one();
+    }
+
+    // draws the resident chunks in the frustum with the bound pipeline (depth or color pass)
+    void draw(const Camera& camera) {
+        glm::vec4 planes[6];
+        camera.frustum_planes(planes);
+        glm::vec2 view = glm::vec2(camera.position.x, camera.position.z);
+
+        Transform().bind(); // vertices are in world space
+        material.bind();
+        glBindVertexArray(vao);
+        // the flat middle is drawn by the environment model already, the terrain stays behind it
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0f, 1.0f);
+        nDrawn = 0;
+        RenderStats::Counters& counters = RenderStats::get().counters();
+        for (size_t i = 0; i < slots.size(); i++) {
+            const Slot& slot = slots[i];
+            if (!slot.bUsed) continue;
+            glm::vec3 boxMin = glm::vec3(slot.coord.x * chunkSize, slot.minHeight - skirtDepth, slot.coord.y * chunkSize);
+            glm::vec3 boxMax = glm::vec3(boxMin.x + chunkSize, slot.maxHeight, boxMin.z + chunkSize);
+            if (!is_visible(planes, boxMin, boxMax)) continue;
+
+            uint32_t lod = 0;
+            float distance = chunk_distance(slot.coord, view);
+            while (lod + 1 < nLods && distance > lodDistance * (float)(1u << lod)) lod++;
+            glDrawElementsBaseVertex(GL_TRIANGLES, lodCounts[lod], GL_UNSIGNED_INT, (void*)(lodFirsts[lod] * sizeof(GLuint)), (GLint)(i * chunkVertices));
+            counters.drawCalls++;
+            counters.triangles += lodCounts[lod] / 3;
+            nDrawn++;
+        }
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindVertexArray(0);
+    }
+
+    uint32_t get_resident_count() const { return (uint32_t)std::count_if(slots.begin(), slots.end(), [](const Slot& slot) { return slot.bUsed; }); }
+    uint32_t get_drawn_count() const { return nDrawn; }
+    uint32_t get_pending_count() const { return (uint32_t)pending.size(); }
+
+private:
+    struct Slot {
+        glm::ivec2 coord = glm::ivec2(0);
+        float minHeight = 0.0f;
+        float maxHeight = 0.0f;
+        bool bUsed = false;
+    };
+    struct GeneratedChunk {
+        glm::ivec2 coord;
+        float minHeight;
+        float maxHeight;
+        std::vector<Vertex> vertices;
+    };
+
+    // distance on the xz plane from the view to the nearest point of a chunk
+    float chunk_distance(glm::ivec2 coord, glm::vec2 view) const {
+        glm::vec2 lower = glm::vec2(coord) * chunkSize;
+        return glm::distance(glm::clamp(view, lower, lower + chunkSize), view);
+    }
+    int find_slot(glm::ivec2 coord) const {
+        for (size_t i = 0; i < slots.size(); i++)
+            if (slots[i].bUsed && slots[i].coord == coord) return (int)i;
+        return -1;
+    }
+    // an unused slot, or the one of the farthest chunk outside the stream radius, -1 if all are needed
+    int free_slot(glm::vec2 view) const {
+        int farthest = -1;
+        float farthestDistance = streamRadius;
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!slots[i].bUsed) return (int)i;
+            float distance = chunk_distance(slots[i].coord, view);
+            if (distance > farthestDistance) {
+                farthest = (int)i;
+                farthestDistance = distance;
+            }
+        }
+        return farthest;
+    }
+    static bool is_visible(const glm::vec4 planes[6], glm::vec3 boxMin, glm::vec3 boxMax) {
+        for (int i = 0; i < 6; i++) {
+            glm::vec3 farthest = glm::mix(boxMin, boxMax, glm::step(glm::vec3(0.0f), glm::vec3(planes[i])));
+            if (glm::dot(glm::vec3(planes[i]), farthest) + planes[i].w < 0.0f) return false;
+        }
+        return true;
+    }
+
+    // worker thread: generates the requested chunks one after another
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return bStop || !requests.empty(); });
+            if (bStop) return;
+            glm::ivec2 coord = requests.front();
+            requests.pop_front();
+            lock.unlock();
+            GeneratedChunk chunk = generate(coord);
+            lock.lock();
+            finished.push_back(std::move(chunk));
+        }
+    }
+    GeneratedChunk generate(glm::ivec2 coord) const {
+        GeneratedChunk chunk = { coord, FLT_MAX, -FLT_MAX, std::vector<Vertex>(chunkVertices) };
+        glm::vec3 grass = glm::vec3(0.32f, 0.42f, 0.18f);
+        glm::vec3 rock = glm::vec3(0.45f, 0.42f, 0.38f);
+        for (uint32_t z = 0; z < rowVertices; z++) {
+            for (uint32_t x = 0; x < rowVertices; x++) {
+                // grid points in world units, exactly the points Heightfield::height interpolates
+                float worldX = (float)(coord.x * (int)chunkQuads + (int)x) * heightfield.spacing;
+                float worldZ = (float)(coord.y * (int)chunkQuads + (int)z) * heightfield.spacing;
+                Vertex& vertex = chunk.vertices[z * rowVertices + x];
+                vertex.pos = glm::vec3(worldX, heightfield.sample(worldX, worldZ), worldZ);
+                vertex.norm = heightfield.normal(worldX, worldZ);
+                vertex.st = glm::vec2(worldX, worldZ) * 0.25f; // texture repeats every 4 m
+                float slope = glm::smoothstep(0.75f, 0.95f, vertex.norm.y); // steep parts are rock
+                vertex.col = glm::vec4(glm::mix(rock, grass, slope), 1.0f);
+                chunk.minHeight = std::min(chunk.minHeight, vertex.pos.y);
+                chunk.maxHeight = std::max(chunk.maxHeight, vertex.pos.y);
+            }
+        }
+        // skirts: copies of the border vertices, moved down
+        for (uint32_t side = 0; side < 4; side++) {
+            for (uint32_t k = 0; k < rowVertices; k++) {
+                Vertex vertex = chunk.vertices[border_vertex(side, k)];
+                vertex.pos.y -= skirtDepth;
+                chunk.vertices[gridVertices + side * rowVertices + k] = vertex;
+            }
+        }
+        return chunk;
+    }
+    // k-th vertex along a chunk border: 0 = first row, 1 = last row, 2 = first column, 3 = last column
+    static uint32_t border_vertex(uint32_t side, uint32_t k) {
+        switch (side) {
+            case 0: return k;
+            case 1: return chunkQuads * rowVertices + k;
+            case 2: return k * rowVertices;
+            default: return k * rowVertices + chunkQuads;
+        }
+    }
+
+    // one index buffer for all chunks, a range per LOD
+    void create_indices() {
+        std::vector<GLuint> indices;
+        for (uint32_t lod = 0; lod < nLods; lod++) {
+            uint32_t step = 1u << lod;
+            lodFirsts[lod] = (GLuint)indices.size();
+            for (uint32_t z = 0; z < chunkQuads; z += step) {
+                for (uint32_t x = 0; x < chunkQuads; x += step) {
+                    // split along the same diagonal as Heightfield::height
+                    GLuint a = z * rowVertices + x;
+                    GLuint b = a + step;
+                    GLuint c = a + step * rowVertices + step;
+                    GLuint d = a + step * rowVertices;
+                    indices.insert(indices.end(), { a, c, b, a, d, c });
+                }
+            }
+            for (uint32_t side = 0; side < 4; side++) {
+                for (uint32_t k = 0; k < chunkQuads; k += step) {
+                    GLuint a = border_vertex(side, k);
+                    GLuint b = border_vertex(side, k + step);
+                    GLuint skirtA = gridVertices + side * rowVertices + k;
+                    GLuint skirtB = skirtA + step;
+                    indices.insert(indices.end(), { a, skirtA, skirtB, a, skirtB, b });
+                }
+            }
+            lodCounts[lod] = (GLsizei)(indices.size() - lodFirsts[lod]);
+        }
+        glCreateBuffers(1, &ebo);
+        glNamedBufferStorage(ebo, indices.size() * sizeof(GLuint), indices.data(), BufferStorageMask::GL_NONE_BIT);
+    }
+    // same vertex format as Mesh, the chunks are drawn with the scene pipelines
+    void describe_layout() {
+        glCreateVertexArrays(1, &vao);
+        glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(Vertex));
+        glVertexArrayElementBuffer(vao, ebo);
+        GLuint offsets[] = { 0, 3, 6, 8 }; // position, normal, uv coordinate, color
+        GLint sizes[] = { 3, 3, 2, 4 };
+        for (GLuint i = 0; i < 4; i++) {
+            glVertexArrayAttribFormat(vao, i, sizes[i], GL_FLOAT, GL_FALSE, offsets[i] * sizeof(GLfloat));
+            glVertexArrayAttribBinding(vao, i, 0);
+            glEnableVertexArrayAttrib(vao, i);
+        }
+    }
+    // grass texture of the environment, tinted by the vertex colors (rock on steep slopes)
+    void load_material() {
+        std::string path = "models/Environment/textures/grass02_albedo.png";
+        int width, height, nChannels;
+        #ifdef EMBEDDED_MODELS
+        auto rawTex = load_model_resource(path);
+        stbi_uc* pImage = rawTex.first ? stbi_load_from_memory(rawTex.first, (int)rawTex.second, &width, &height, &nChannels, 4) : nullptr;
+        #else
+        path = "../" + path; // adjust path when reading from disk
+        stbi_uc* pImage = stbi_load(path.c_str(), &width, &height, &nChannels, 4);
+        #endif
+        material.specular = glm::vec3(0.0f);
+        if (pImage == nullptr) {
+            std::cerr << "failed to load terrain texture, using vertex colors" << std::endl;
+            return;
+        }
+        glCreateTextures(GL_TEXTURE_2D, 1, &material.diffuseTexture);
+        glTextureStorage2D(material.diffuseTexture, (GLsizei)std::log2(std::max(width, height)) + 1, GL_RGBA8, width, height);
+        glTextureSubImage2D(material.diffuseTexture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pImage);
+        glTextureParameteri(material.diffuseTexture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(material.diffuseTexture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glGenerateTextureMipmap(material.diffuseTexture);
+        glTextureParameteri(material.diffuseTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(material.diffuseTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        stbi_image_free(pImage);
+        material.diffuseBlend = 0.8f;
+    }
+
+    Heightfield heightfield;
+    float chunkSize;
+    GLuint vbo, ebo, vao;
+    std::array<GLuint, nLods> lodFirsts;
+    std::array<GLsizei, nLods> lodCounts;
+    Material material;
+    std::array<Slot, capacity> slots;
+    std::vector<glm::ivec2> pending; // requested, not uploaded yet (render thread)
+    std::vector<glm::ivec2> missing; // scratch
+    std::vector<GeneratedChunk> arrived; // scratch
+    uint32_t nDrawn = 0;
+    // shared with the worker
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<glm::ivec2> requests;
+    std::deque<GeneratedChunk> finished;
+    bool bStop = false;
+    std::thread worker;
+};
@@ -2,26 +2,33 @@
 #include <chrono>
 
 struct Timer {
+    typedef std::chrono::steady_clock clock; // monotonic, high_resolution_clock may jump with the wall clock
+
     void update() {
         // set timestamp and calculate duration
         clock::time_point current = clock::now();
-        auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(current - previous).count();
+        deltaTime = current - previous;
         previous = current;
 
-        // convert to useful metric
-        delta = (float)microseconds;
-        delta *= 0.000001f; // microseconds to seconds
+        // convert to useful metric (kept in full clock resolution, no truncation to microseconds)
+        delta = std::chrono::duration<double>(deltaTime).count();
     }
 
     float get_fps() {
-        return 1.0f / delta;
+        return (float)(1.0 / delta);
     }
     float get_delta() {
-        return delta;
+        return (float)delta;
+    }
+    double get_delta_ms() {
+        return delta * 1000.0;
+    }
+    clock::time_point get_time() {
+        return previous;
     }
 
 private:
-    typedef std::chrono::high_resolution_clock clock;
     clock::time_point previous = clock::now();
-    float delta = 0.0f;
-};
\ No newline at end of file
+    clock::duration deltaTime = clock::duration::zero();
+    double delta = 0.0;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+// Lock-free handoff between exactly one producer and one consumer thread.
+// The producer owns one slot, the consumer owns another and the third is swapped atomically,
+// so neither side ever waits: the consumer just keeps reading the newest published slot.
+template<typename T>
+struct TripleBuffer {
+    // slot the producer may fill (still holds data from an older publish, overwrite it completely)
+    T& write() noexcept {
+        return slots[backIndex];
+    }
+    // hand the filled slot over to the consumer and take back whatever it is not using
+    void publish() noexcept {
+        uint8_t previous = middle.exchange(backIndex | dirtyBit, std::memory_order_acq_rel);
+        backIndex = previous & indexMask;
+    }
+    // newest published slot (or the last one read if nothing new was published since)
+    T& read() noexcept {
+        if (middle.load(std::memory_order_relaxed) & dirtyBit) {
+            uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = previous & indexMask;
+        }
+        return slots[frontIndex];
+    }
+
+private:
+    static constexpr uint8_t indexMask = 0b011;
+    static constexpr uint8_t dirtyBit = 0b100;
+
+    std::array<T, 3> slots;
+    std::atomic<uint8_t> middle = 1;
+    uint8_t backIndex = 0; // only touched by the producer
+    uint8_t frontIndex = 2; // only touched by the consumer
+};
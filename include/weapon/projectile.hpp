@@ -1,58 +1,17 @@
 #pragma once
 
 // External libraries
-#include <glbinding/gl46core/gl.h>
-#include <glbinding/glbinding.h>
-#include <SDL.h>
 #include <glm/gtc/matrix_transform.hpp> // https://glm.g-truc.net/0.9.2/api/a00245.html
 #include <glm/gtx/euler_angles.hpp>     // https://glm.g-truc.net/0.9.1/api/a00251.html
-#include <glm/gtc/type_ptr.hpp>         // allows use of glm::value_ptr to get raw pointer to data
 
-#include "game_objects/model.hpp"
-
-#include "weapon/raycastHit.hpp"
-
-//Class that controls the creation and control of the weapon's ammunition objects
-struct Projectile : public Model
+// State of one of the weapon's ammunition objects, plain data that lives in a slot of the ProjectilePool
+// (the projectile model is shared and drawn by the render thread)
+struct Projectile
 {
-    Projectile(glm::vec3 pos, glm::vec3 rot, glm::vec3 scale, std::string path)
-        : Model(pos, rot, scale, path)
-    {
-        startPoint = pos;
-    }
-
-    void move(float x, float y, float z)
-    {
-        transform.position += glm::quat(transform.rotation) * glm::vec3(x, y, z);
-    }
-
-    bool maxFlyDistanceAchieved()
-    {
-
-        if (distanceBetweenPoints(startPoint, transform.position) > maxFlyDistance)
-        {
-            return true;
-        }
-        else
-        {
-            return false;
-        }
-    }
-
-public:
-    float movementSpeed = 100.f;
-    int ID;
-
-private:
-    float maxFlyDistance = 90.f;
+    glm::vec3 position;
+    glm::vec3 rotation; // euler, only used for drawing
+    glm::vec3 direction; // unit flight direction
     glm::vec3 startPoint;
-    
-    float distanceBetweenPoints(const glm::vec3 &p1, const glm::vec3 &p2)
-    {
-        float dx = p2.x - p1.x;
-        float dy = p2.y - p1.y;
-        float dz = p2.z - p1.z;
-
-        return std::sqrt(dx * dx + dy * dy + dz * dz);
-    }
-};
\ No newline at end of file
+    float lifetime; // seconds since the shot
+    bool alive;
+};
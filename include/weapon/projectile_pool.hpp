@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+#include "weapon/projectile.hpp"
+
+// Fixed-capacity ring buffer of projectiles, spawning and freeing are O(1) and never touch the heap.
+// All projectiles fly equally fast and far, so they expire in the order they were shot:
+// new ones are added at the back, expired ones are freed from the front.
+template<size_t Capacity>
+struct ProjectilePool
+{
+    // Starts a new projectile, overwrites the oldest one if the pool is full
+    Projectile &spawn(glm::vec3 position, glm::vec3 rotation, glm::vec3 direction)
+    {
+        if (count == Capacity)
+            pop_front();
+
+        Projectile &projectile = slots[(first + count) % Capacity];
+        projectile = {position, rotation, direction, position, 0.0f, true};
+        count++;
+        return projectile;
+    }
+
+    // Moves all projectiles and frees the ones that reached their maximum distance
+    void update(float delta)
+    {
+        float maxFlyDistance2 = maxFlyDistance * maxFlyDistance;
+        for_each([&](Projectile &projectile) {
+            projectile.position += projectile.direction * (movementSpeed * delta);
+            projectile.lifetime += delta;
+            glm::vec3 flown = projectile.position - projectile.startPoint;
+            if (glm::dot(flown, flown) > maxFlyDistance2)
+                projectile.alive = false;
+        });
+
+        while (count > 0 && !slots[first].alive)
+            pop_front();
+    }
+
+    template<typename Function>
+    void for_each(Function function)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            Projectile &projectile = slots[(first + i) % Capacity];
+            if (projectile.alive)
+                function(projectile);
+        }
+    }
+
+    void clear()
+    {
+        first = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+
+    float movementSpeed = 100.f;
+    float maxFlyDistance = 90.f;
+
+private:
+    void pop_front()
+    {
+        slots[first].alive = false;
+        first = (first + 1) % Capacity;
+        count--;
+    }
+
+    std::array<Projectile, Capacity> slots = {};
+    size_t first = 0;
+    size_t count = 0;
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "weapon/projectile.hpp"
+#include "weapon/projectile_pool.hpp"
 
 struct Weapon
 {
@@ -18,36 +18,13 @@ struct Weapon
     unsigned int currentReloadTime = 0;
     unsigned int reloadTime = 300;
 
-    std::list<Projectile> projectilesList;
-    int projectNumbers = 0;
+    ProjectilePool<128> projectiles;
 
-    // Creates the projectile and adds it to the list
+    // Starts a projectile in front of the player (takes a free slot of the pool, no allocation)
     void shootProjectile(glm::vec3 playerPos, glm::vec3 playerRot)
     {
-        glm::vec3 spawnPosition = playerPos += glm::quat(playerRot) * glm::vec3(0, 0, -1.5f);
-        Projectile newProjectile = Projectile(playerPos, playerRot, {0.2, 0.2, 0.2}, "models/test/cube.obj");
-        newProjectile.ID = projectNumbers;
-        projectilesList.push_back(newProjectile);
-
-        projectNumbers += 1;
-    }
-
-    // Delte the projectile and remove it from the list
-    void deleteProjectile(int id, std::list<Projectile> &listToDeleteFrom)
-    {
-        for (auto it = listToDeleteFrom.begin(); it != listToDeleteFrom.end();)
-        {
-            if (it->ID == id)
-            {
-                std::cout << "Projectile deleted" << std::endl;
-                it = listToDeleteFrom.erase(it);
-                projectNumbers--;
-            }
-            else
-            {
-                ++it;
-            }
-        }
+        glm::vec3 direction = glm::quat(playerRot) * glm::vec3(0, 0, -1.0f);
+        projectiles.spawn(playerPos + direction * 1.5f, playerRot, direction);
     }
 
     // Called before shooting. This is where you check whether you can shoot at all, whether there is ammunition or whether the cooldown period is over.
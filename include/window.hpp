@@ -1,9 +1,10 @@
 #pragma once
 
 struct Window {
-    Window(int window_width, int window_height, int nSamples);
+    Window(int window_width, int window_height, int nSamples, bool bHidden = false);
     ~Window();
     void swap();
+    void set_swap_interval(int interval);
     void handle_event(SDL_Event& event) {
         // TODO
     }
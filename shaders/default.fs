@@ -5,6 +5,9 @@ layout (location = 0) in vec3 worldPos;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 uvCoord;
 layout (location = 3) in vec4 vertCol;
+#ifdef SKINNING
+layout (location = 4) flat in vec3 instanceOrigin;
+#endif
 // output
 layout (location = 0) out vec4 pixelColor;
 
@@ -27,13 +30,37 @@ struct Light { // assuming this is a point light
 // uniform constants
 layout (location = 16) uniform Camera camera;
 layout (location = 17) uniform Material material;
+#ifndef N_LIGHTS
 #define N_LIGHTS 2
+#endif
+// 0: single tap, 1: 2x2x2 PCF, 2: 4x4x4 PCF
+#ifndef SHADOW_QUALITY
+#define SHADOW_QUALITY 2
+#endif
 layout (location = 23) uniform Light lights[N_LIGHTS]; // 23, 26
 
 // texture samplers
 layout (binding = 0) uniform sampler2D diffuseTexture;
 layout (binding = 1) uniform samplerCube shadowMaps[N_LIGHTS]; // binding 1, 2
 
+#ifdef CLUSTERED_LIGHTING
+// unshadowed point lights, sorted into clusters by cluster_cull.comp
+struct ClusterLight {
+    vec4 positionRadius;
+    vec4 color;
+};
+layout (std430, binding = 0) readonly buffer LightBuffer { ClusterLight clusterLights[]; };
+layout (std430, binding = 1) readonly buffer ClusterBuffer { uint clusterCounts[]; };
+layout (std430, binding = 2) readonly buffer IndexBuffer { uint clusterLightIndices[]; };
+layout (location = 40) uniform uvec4 clusterGrid;  // x, y, z, max lights per cluster
+layout (location = 41) uniform vec4 clusterDepth;  // near, far, slice scale, slice bias
+layout (location = 42) uniform vec2 screenSize;
+#endif
+#ifdef SKINNING
+// instances between start and end distance dither out while their impostor dithers in (impostor.fs), off if end <= start
+layout (location = 46) uniform vec2 fadeRange;
+#endif
+
 // indirect scattered light
 vec3 calc_ambient() {
     float ambientStrength = 1.0; // ambient modifier
@@ -64,7 +91,7 @@ float calc_shadow(uint i) {
     float currentDepth = length(fragToLight);
     
     // percentage closer filter
-    float samples = 4.0;
+    float samples = SHADOW_QUALITY == 1 ? 2.0 : 4.0;
     float offset  = 0.1;
     float shadow = 0.0;
     for(float x = -offset; x < offset; x += offset / (samples * 0.5)) {
@@ -92,13 +119,50 @@ float calc_shadow_perf(uint i) {
     if(currentDepth - bias < closestDepth) shadow += 1.0;
     return shadow;
 }
+#ifdef CLUSTERED_LIGHTING
+vec3 calc_cluster_lights() {
+    // find the cluster of this fragment (linear depth from the depth buffer value)
+    float near = clusterDepth.x;
+    float far = clusterDepth.y;
+    float ndcDepth = gl_FragCoord.z * 2.0 - 1.0;
+    float viewDepth = 2.0 * near * far / (far + near - ndcDepth * (far - near));
+    uint slice = uint(max(log(viewDepth) * clusterDepth.z + clusterDepth.w, 0.0));
+    uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy / screenSize * vec2(clusterGrid.xy)), slice), clusterGrid.xyz - 1);
+    uint clusterIndex = cluster.x + cluster.y * clusterGrid.x + cluster.z * clusterGrid.x * clusterGrid.y;
+
+    vec3 cameraDir = normalize(camera.worldPos - worldPos); // unit vector from camera to fragment
+    vec3 color = vec3(0.0, 0.0, 0.0);
+    uint count = clusterCounts[clusterIndex];
+    uint base = clusterIndex * clusterGrid.w;
+    for (uint i = 0; i < count; i++) {
+        ClusterLight light = clusterLights[clusterLightIndices[base + i]];
+        vec3 toLight = light.positionRadius.xyz - worldPos;
+        float lightDist = length(toLight);
+        vec3 lightDir = toLight / lightDist;
+
+        // inverse square falloff that reaches zero at the radius
+        float falloff = clamp(1.0 - pow(lightDist / light.positionRadius.w, 4.0), 0.0, 1.0);
+        float attenuation = falloff * falloff / (1.0 + lightDist * lightDist);
+
+        float diffuseStrength = max(dot(normal, lightDir), 0.0);
+        vec3 reflectDir = reflect(-lightDir, normal);
+        float specularStrength = material.shininessStrength * pow(max(dot(cameraDir, reflectDir), 0.0), material.shininess);
+        color += light.color.rgb * attenuation * (diffuseStrength * material.diffuse + specularStrength * material.specular);
+    }
+    return color;
+}
+#endif
 vec4 calc_light() {
     // calculate lighting
     vec3 ambientColor = calc_ambient();
     vec3 specularColor = vec3(0.0, 0.0, 0.0);
     vec3 diffuseColor = vec3(0.0, 0.0, 0.0);
     for (uint i = 0; i < N_LIGHTS; i++) {
+#if SHADOW_QUALITY == 0
+        float shadow = calc_shadow_perf(i);
+#else
         float shadow = calc_shadow(i);
+#endif
 
         vec3 lightDir = normalize(lights[i].worldPos - worldPos); // unit vector from light to fragment
         float lightDist = length(lightDir);
@@ -110,6 +174,10 @@ vec4 calc_light() {
         specularColor += calc_specular(i) * shadow * attenuation;
     }
 
+#ifdef CLUSTERED_LIGHTING
+    diffuseColor += calc_cluster_lights();
+#endif
+
     // blend texture/vertex colors
     vec4 sampledColor = texture(diffuseTexture, uvCoord);
     vec4 color = mix(vertCol, sampledColor, material.diffuseBlend);
@@ -125,6 +193,14 @@ vec4 calc_debug() {
 }
 
 void main() {
+#ifdef SKINNING
+    if (fadeRange.y > fadeRange.x) {
+        const float bayer[16] = float[16](0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5);
+        float threshold = (bayer[(uint(gl_FragCoord.y) % 4u) * 4u + uint(gl_FragCoord.x) % 4u] + 0.5) / 16.0;
+        float fade = clamp((distance(camera.worldPos, instanceOrigin) - fadeRange.x) / (fadeRange.y - fadeRange.x), 0.0, 1.0);
+        if (fade > threshold) discard;
+    }
+#endif
     pixelColor = calc_light();
     // pixelColor = calc_debug();
 }
\ No newline at end of file
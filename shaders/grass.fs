@@ -0,0 +1,38 @@
+#version 460 core // OpenGL 4.6
+
+// input (location matches vertex shader "out")
+layout (location = 0) in vec3 worldPos;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in float bladeHeight;
+layout (location = 3) flat in float variation;
+// output
+layout (location = 0) out vec4 pixelColor;
+
+struct Light { // same locations as default.fs
+    vec3 worldPos; // 23
+    vec3 color;
+    float radius;
+};
+#ifndef N_LIGHTS
+#define N_LIGHTS 2
+#endif
+layout (location = 23) uniform Light lights[N_LIGHTS];
+
+void main() {
+    // darker at the root (ambient occlusion of the field), lighter and slightly varied at the tip
+    vec3 rootColor = vec3(0.05, 0.12, 0.03);
+    vec3 tipColor = mix(vec3(0.25, 0.45, 0.1), vec3(0.4, 0.5, 0.15), variation);
+    vec3 albedo = mix(rootColor, tipColor, bladeHeight);
+    vec3 bladeNormal = gl_FrontFacing ? normal : -normal; // two sided
+
+    // ambient and wrapped diffuse (thin blades let light through), no shadow maps like impostor.fs
+    vec3 color = albedo * 0.3;
+    const float attenuation = 1.0 / (1.0 + 0.14 + 0.07);
+    for (uint i = 0; i < N_LIGHTS; i++) {
+        vec3 toLight = lights[i].worldPos - worldPos;
+        float inRange = step(length(toLight), lights[i].radius);
+        float diffuse = max(dot(bladeNormal, normalize(toLight)) * 0.6 + 0.4, 0.0);
+        color += albedo * lights[i].color * diffuse * attenuation * inRange;
+    }
+    pixelColor = vec4(color, 1.0);
+}
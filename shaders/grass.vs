@@ -0,0 +1,51 @@
+#version 460 core // OpenGL 4.6
+
+// grass blades spawned by grass_cull.comp, 7 vertices (triangle strip of 3 segments and the tip) per instance
+struct Blade {
+    vec4 positionYaw; // world space root, rotation about y
+    vec4 shape;       // height, width, forward bend, color variation
+};
+layout (std430, binding = 6) readonly buffer BladeBuffer { Blade blades[]; };
+
+// output (location matches fragment shader "in")
+layout (location = 0) out vec3 worldPos;
+layout (location = 1) out vec3 normal;
+layout (location = 2) out float bladeHeight; // 0 at the root, 1 at the tip
+layout (location = 3) flat out float variation;
+// uniforms
+layout (location = 4) uniform mat4 viewMatrix;
+layout (location = 8) uniform mat4 perspectiveMatrix;
+layout (location = 40) uniform float time;
+layout (location = 41) uniform vec4 wind; // direction xz, strength, wave length
+
+void main() {
+    Blade blade = blades[gl_InstanceID];
+    const float nSegments = 3.0;
+    float t = min(float(gl_VertexID >> 1) / nSegments, 1.0);
+    float side = gl_VertexID == 6 ? 0.0 : float(gl_VertexID & 1) * 2.0 - 1.0;
+
+    float s = sin(blade.positionYaw.w);
+    float c = cos(blade.positionYaw.w);
+    vec3 facing = vec3(s, 0.0, c);
+    vec3 across = vec3(c, 0.0, -s);
+
+    // gusts travel over the field along the wind, each blade sways a little out of phase
+    vec2 root = blade.positionYaw.xz;
+    float phase = dot(root, wind.xy) / wind.w * 6.2831853 - time * 2.0 + blade.shape.w * 3.0;
+    float gust = (sin(phase) * 0.5 + 0.5) * wind.z;
+    float flutter = sin(time * 5.0 + blade.shape.w * 20.0) * 0.05;
+    vec3 lean = facing * blade.shape.z + vec3(wind.x, 0.0, wind.y) * (gust + flutter);
+
+    // quadratic bend, the root stays in place and the tip moves most
+    float height = blade.shape.x;
+    vec3 position = vec3(root.x, blade.positionYaw.y, root.y) + across * side * blade.shape.y * (1.0 - t)
+                  + vec3(0.0, t * height, 0.0) + lean * t * t * height;
+    position.y -= dot(lean, lean) * t * t * height * 0.3; // bent blades get shorter
+    vec3 tangent = vec3(0.0, height, 0.0) + lean * 2.0 * t * height;
+    normal = normalize(cross(across, tangent));
+
+    worldPos = position;
+    bladeHeight = t;
+    variation = blade.shape.w;
+    gl_Position = perspectiveMatrix * viewMatrix * vec4(position, 1.0);
+}
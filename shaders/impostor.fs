@@ -0,0 +1,45 @@
+#version 460 core // OpenGL 4.6
+
+// input (location matches vertex shader "out")
+layout (location = 0) in vec3 worldPos;
+layout (location = 1) in vec2 atlasCoord;
+layout (location = 2) flat in vec2 yaw;
+layout (location = 3) flat in float fade;
+// output
+layout (location = 0) out vec4 pixelColor;
+
+struct Light { // same locations as default.fs
+    vec3 worldPos; // 23
+    vec3 color;
+    float radius;
+};
+#ifndef N_LIGHTS
+#define N_LIGHTS 2
+#endif
+layout (location = 23) uniform Light lights[N_LIGHTS];
+// atlas of Impostor::bake
+layout (binding = 8) uniform sampler2D albedoAtlas;
+layout (binding = 9) uniform sampler2D normalAtlas;
+
+void main() {
+    // complement of the mesh dither in default.fs
+    const float bayer[16] = float[16](0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5);
+    float threshold = (bayer[(uint(gl_FragCoord.y) % 4u) * 4u + uint(gl_FragCoord.x) % 4u] + 0.5) / 16.0;
+    if (fade <= threshold) discard;
+
+    vec4 albedo = texture(albedoAtlas, atlasCoord);
+    if (albedo.a < 0.5) discard;
+    vec4 encoded = texture(normalAtlas, atlasCoord);
+    vec3 objectNormal = normalize(encoded.xyz * 2.0 - 1.0);
+    vec3 normal = vec3(yaw.y * objectNormal.x + yaw.x * objectNormal.z, objectNormal.y, -yaw.x * objectNormal.x + yaw.y * objectNormal.z);
+
+    // ambient and diffuse of default.fs, without shadow maps and specular (outside of a light's radius counts as shadowed)
+    vec3 color = albedo.rgb * 0.1 + encoded.a;
+    const float attenuation = 1.0 / (1.0 + 0.14 + 0.07);
+    for (uint i = 0; i < N_LIGHTS; i++) {
+        vec3 toLight = lights[i].worldPos - worldPos;
+        float inRange = step(length(toLight), lights[i].radius);
+        color += albedo.rgb * lights[i].color * max(dot(normal, normalize(toLight)), 0.0) * attenuation * inRange;
+    }
+    pixelColor = vec4(color, 1.0);
+}
@@ -0,0 +1,64 @@
+#version 460 core // OpenGL 4.6
+
+// quads of an octahedral impostor, 4 vertices (triangle strip) per instance, no vertex buffer
+struct ImpostorInstance {
+    vec4 positionScale; // world space position of the model origin, uniform scale
+    vec4 rotation;      // x = yaw
+};
+layout (std430, binding = 5) readonly buffer ImpostorBuffer { ImpostorInstance impostors[]; };
+
+// output (location matches fragment shader "in")
+layout (location = 0) out vec3 worldPos;
+layout (location = 1) out vec2 atlasCoord;
+layout (location = 2) flat out vec2 yaw;   // sin, cos
+layout (location = 3) flat out float fade; // 0 = mesh only, 1 = impostor only
+// uniforms
+layout (location = 4) uniform mat4 viewMatrix;
+layout (location = 8) uniform mat4 perspectiveMatrix;
+layout (location = 16) uniform vec3 cameraPosition;
+layout (location = 46) uniform vec2 fadeRange; // same as default.fs
+layout (location = 47) uniform vec4 bounds;    // bounding sphere in object space
+layout (location = 48) uniform float nFrames;  // per atlas side
+
+// rotation about y like glm::yawPitchRoll(yaw, 0, 0)
+vec3 rotate_yaw(vec3 v, float s, float c) {
+    return vec3(c * v.x + s * v.z, v.y, -s * v.x + c * v.z);
+}
+// upper hemisphere <-> [-1, 1]^2
+vec2 hemi_octahedral_encode(vec3 direction) {
+    vec2 p = direction.xz / (abs(direction.x) + abs(direction.y) + abs(direction.z));
+    return vec2(p.x + p.y, p.x - p.y);
+}
+vec3 hemi_octahedral_decode(vec2 uv) {
+    vec2 p = vec2(uv.x + uv.y, uv.x - uv.y) * 0.5;
+    return normalize(vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y));
+}
+
+void main() {
+    ImpostorInstance instance = impostors[gl_InstanceID];
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    float s = sin(instance.rotation.x);
+    float c = cos(instance.rotation.x);
+    float scale = instance.positionScale.w;
+    vec3 center = instance.positionScale.xyz + rotate_yaw(bounds.xyz, s, c) * scale;
+
+    // nearest baked view of the direction towards the camera (object space, views from below use the horizon)
+    vec3 toCamera = rotate_yaw(cameraPosition - center, -s, c);
+    toCamera.y = max(toCamera.y, 0.0);
+    vec2 octahedral = hemi_octahedral_encode(normalize(toCamera + vec3(0.0, 1e-4, 0.0)));
+    vec2 frame = round((octahedral * 0.5 + 0.5) * (nFrames - 1.0));
+    vec3 viewDir = hemi_octahedral_decode(frame / (nFrames - 1.0) * 2.0 - 1.0);
+
+    // the quad faces the baked view with the axes of the bake camera (glm::lookAt in Impostor::bake)
+    vec3 reference = abs(viewDir.y) > 0.999 ? vec3(0.0, 0.0, -1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(reference, viewDir));
+    vec3 up = cross(viewDir, right);
+    vec3 offset = (corner.x * right + corner.y * up) * bounds.w * scale;
+    worldPos = center + rotate_yaw(offset, s, c);
+    atlasCoord = (frame + corner * 0.5 + 0.5) / nFrames;
+    yaw = vec2(s, c);
+    fade = 1.0;
+    if (fadeRange.y > fadeRange.x)
+        fade = clamp((distance(cameraPosition, instance.positionScale.xyz) - fadeRange.x) / (fadeRange.y - fadeRange.x), 0.0, 1.0);
+    gl_Position = perspectiveMatrix * viewMatrix * vec4(worldPos, 1.0);
+}
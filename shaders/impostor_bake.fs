@@ -0,0 +1,30 @@
+#version 460 core // OpenGL 4.6
+
+// renders the views of an impostor atlas (with default.vs): unlit color and object space normal
+layout (location = 0) in vec3 worldPos;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uvCoord;
+layout (location = 3) in vec4 vertCol;
+// output (atlas textures)
+layout (location = 0) out vec4 albedo;        // rgb = color * diffuse, a = coverage
+layout (location = 1) out vec4 encodedNormal; // rgb = normal * 0.5 + 0.5, a = ambient
+
+struct Material {
+    vec3 ambient; // 17
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+    float shininessStrength;
+    float diffuseBlend;
+};
+layout (location = 17) uniform Material material;
+layout (binding = 0) uniform sampler2D diffuseTexture;
+
+void main() {
+    vec4 sampledColor = texture(diffuseTexture, uvCoord);
+    vec4 color = mix(vertCol, sampledColor, material.diffuseBlend);
+    albedo = vec4(color.rgb * material.diffuse, 1.0);
+    // the ambient term of default.fs that does not scale with the diffuse color, as gray
+    float ambient = dot(color.rgb * material.ambient, vec3(1.0 / 3.0));
+    encodedNormal = vec4(normalize(normal) * 0.5 + 0.5, ambient);
+}
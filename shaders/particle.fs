@@ -0,0 +1,30 @@
+#version 460 core // OpenGL 4.6
+
+// input (location matches vertex shader "out")
+layout (location = 0) in vec2 corner;
+layout (location = 1) in vec4 color;
+layout (location = 2) in float viewDepth;
+// output
+layout (location = 0) out vec4 outColor;
+
+// uniforms
+layout (location = 20) uniform vec2 clipPlanes; // near, far
+layout (location = 21) uniform float softness;  // depth range (world units) over which particles fade into the scene
+layout (binding = 0) uniform sampler2D sceneDepth;
+
+float linear_depth(float depth) {
+    float z = depth * 2.0 - 1.0;
+    return 2.0 * clipPlanes.x * clipPlanes.y / (clipPlanes.y + clipPlanes.x - z * (clipPlanes.y - clipPlanes.x));
+}
+
+void main() {
+    float shape = 1.0 - dot(corner, corner); // round particles
+    if (shape <= 0.0) discard;
+
+    // depth test in the shader: soft fade instead of hard edges where particles intersect the scene
+    float sceneZ = linear_depth(texelFetch(sceneDepth, ivec2(gl_FragCoord.xy), 0).r);
+    float fade = clamp((sceneZ - viewDepth) / softness, 0.0, 1.0);
+    if (fade <= 0.0) discard;
+
+    outColor = color * shape * fade; // premultiplied
+}
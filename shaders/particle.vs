@@ -0,0 +1,36 @@
+#version 460 core // OpenGL 4.6
+
+// camera facing billboards, 4 vertices (triangle strip) per instance, no vertex buffer
+struct Particle {
+    vec4 positionSize; // world space position, billboard half size
+    vec4 velocityLife; // velocity, remaining lifetime
+    vec4 color;        // premultiplied, alpha 0 = additive
+    vec4 motion;       // lifetime, gravity, drag
+};
+layout (std430, binding = 0) readonly buffer ParticleBuffer { Particle particles[]; };
+
+// output (location matches fragment shader "in")
+layout (location = 0) out vec2 corner;
+layout (location = 1) out vec4 color;
+layout (location = 2) out float viewDepth;
+// uniforms
+layout (location = 4) uniform mat4 viewMatrix;
+layout (location = 8) uniform mat4 perspectiveMatrix;
+
+void main() {
+    Particle particle = particles[gl_InstanceID];
+    corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    color = vec4(0.0);
+    viewDepth = 0.0;
+    // dead particles are moved outside of the clip volume
+    if (particle.velocityLife.w <= 0.0) {
+        gl_Position = vec4(0.0, 0.0, -2.0, 1.0);
+        return;
+    }
+
+    color = particle.color * (particle.velocityLife.w / particle.motion.x); // fade out over the lifetime
+    vec4 viewPos = viewMatrix * vec4(particle.positionSize.xyz, 1.0);
+    viewPos.xy += corner * particle.positionSize.w;
+    viewDepth = -viewPos.z;
+    gl_Position = perspectiveMatrix * viewPos;
+}
@@ -12,9 +12,63 @@ layout (location = 0) uniform mat4 modelMatrix;
 layout (location = 4) uniform mat4 viewMatrix;
 layout (location = 8) uniform mat4 perspectiveMatrix;
 layout (location = 12) uniform mat3 normalMatrix;
+// also used for the depth pre-pass, its depth has to match default.vs exactly
+invariant gl_Position;
+#ifdef SKINNING
+// instanced skinned draws: joints/weights per vertex, model matrix and animation per instance
+layout (location = 4) in uvec4 joints;
+layout (location = 5) in vec4 weights;
+struct Instance {
+    mat4 modelMatrix;
+    uvec4 animation; // x = first skinning matrix, or BAKED: y = first frame, z = frame count, w = time offset (float bits)
+};
+layout (std430, binding = 3) readonly buffer InstanceBuffer { Instance instances[]; };
+layout (std430, binding = 4) readonly buffer PaletteBuffer { mat4 palettes[]; };
+// crowd instances play a vertex animation texture instead (see VertexAnimation)
+const uint BAKED = 0xFFFFFFFFu;
+layout (binding = 6) uniform sampler2D bakedPositions;
+layout (binding = 7) uniform sampler2D bakedNormals;
+layout (location = 43) uniform float animationTime;    // seconds
+layout (location = 44) uniform uint bakedVertexOffset; // first baked vertex of the drawn mesh
+layout (location = 45) uniform vec2 bakedLayout;       // frames per second, texture rows per frame
+
+ivec2 baked_texel(uint frame) {
+    uint vertex = bakedVertexOffset + uint(gl_VertexID);
+    uint width = uint(textureSize(bakedPositions, 0).x);
+    return ivec2(vertex % width, frame * uint(bakedLayout.y) + vertex / width);
+}
+// object space position and normal of the vertex, skinned with the palette or interpolated between two baked frames
+void animate_vertex(Instance instance, out vec3 outPosition, out vec3 outNormal) {
+    if (instance.animation.x == BAKED) {
+        uint nFrames = instance.animation.z;
+        float frame = mod((animationTime + uintBitsToFloat(instance.animation.w)) * bakedLayout.x, float(nFrames));
+        uint frame0 = min(uint(frame), nFrames - 1u);
+        ivec2 texel0 = baked_texel(instance.animation.y + frame0);
+        ivec2 texel1 = baked_texel(instance.animation.y + (frame0 + 1u) % nFrames); // clips loop
+        float alpha = fract(frame);
+        outPosition = mix(texelFetch(bakedPositions, texel0, 0).xyz, texelFetch(bakedPositions, texel1, 0).xyz, alpha);
+        outNormal = mix(texelFetch(bakedNormals, texel0, 0).xyz, texelFetch(bakedNormals, texel1, 0).xyz, alpha);
+        return;
+    }
+    uint first = instance.animation.x;
+    mat4 skin = palettes[first + joints.x] * weights.x + palettes[first + joints.y] * weights.y
+              + palettes[first + joints.z] * weights.z + palettes[first + joints.w] * weights.w;
+    outPosition = (skin * vec4(pos, 1.0)).xyz;
+    outNormal = mat3(skin) * norm;
+}
+#endif
 
 void main() {
-    gl_Position = modelMatrix * vec4(pos, 1.0);
+#ifdef SKINNING
+    Instance instance = instances[gl_BaseInstance + gl_InstanceID];
+    vec3 position, objectNormal; // normal unused
+    animate_vertex(instance, position, objectNormal);
+    mat4 model = instance.modelMatrix;
+#else
+    vec3 position = pos;
+    mat4 model = modelMatrix;
+#endif
+    gl_Position = model * vec4(position, 1.0);
     worldPos = gl_Position.xyz;
     gl_Position = viewMatrix * gl_Position;
     gl_Position = perspectiveMatrix * gl_Position;
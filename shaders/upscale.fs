@@ -0,0 +1,36 @@
+#version 460 core // OpenGL 4.6
+
+// input (location matches vertex shader "out")
+layout (location = 0) in vec2 uvCoord;
+// output
+layout (location = 0) out vec4 outColor;
+
+// uniforms
+layout (location = 0) uniform vec2 uvScale;   // used part of the source texture
+layout (location = 1) uniform vec2 texelSize; // 1 / source texture size
+layout (location = 2) uniform float sharpness; // 0 = plain bilinear, 1 = strongest
+layout (binding = 0) uniform sampler2D source;
+
+vec3 fetch(vec2 uv) {
+    // stay inside the rendered area, bilinear filtering would pull in stale texels from outside
+    uv = min(uv, uvScale - texelSize * 0.5);
+    return clamp(texture(source, uv).rgb, 0.0, 1.0);
+}
+
+void main() {
+    vec2 uv = uvCoord * uvScale;
+    vec3 center = fetch(uv);
+    vec3 north = fetch(uv + vec2(0.0, texelSize.y));
+    vec3 south = fetch(uv - vec2(0.0, texelSize.y));
+    vec3 east = fetch(uv + vec2(texelSize.x, 0.0));
+    vec3 west = fetch(uv - vec2(texelSize.x, 0.0));
+
+    // contrast adaptive sharpening: less sharpening where the neighbourhood already has high contrast
+    vec3 minColor = min(center, min(min(north, south), min(east, west)));
+    vec3 maxColor = max(center, max(max(north, south), max(east, west)));
+    vec3 amount = sqrt(clamp(min(minColor, 1.0 - maxColor) / max(maxColor, 1e-4), 0.0, 1.0));
+    vec3 weight = -amount * 0.2 * sharpness;
+    vec3 color = (center + (north + south + east + west) * weight) / (1.0 + 4.0 * weight);
+
+    outColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
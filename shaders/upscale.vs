@@ -0,0 +1,11 @@
+#version 460 core // OpenGL 4.6
+
+// output (location matches fragment shader "in")
+layout (location = 0) out vec2 uvCoord;
+
+void main() {
+    // fullscreen triangle without vertex buffer: (-1,-1), (3,-1), (-1,3)
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uvCoord = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
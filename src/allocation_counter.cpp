@@ -0,0 +1,30 @@
+#include <new>
+#include <cstdlib>
+//
+#include "allocation_counter.hpp"
+
+#ifndef NDEBUG
+static thread_local uint64_t threadAllocations = 0;
+
+uint64_t AllocationCounter::get() noexcept {
+    return threadAllocations;
+}
+
+// replace the global allocation functions (array and nothrow versions forward to these)
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    if (size == 0) size = 1;
+    if (void* pMemory = std::malloc(size)) return pMemory;
+    throw std::bad_alloc();
+}
+void operator delete(void* pMemory) noexcept {
+    std::free(pMemory);
+}
+void operator delete(void* pMemory, std::size_t) noexcept {
+    std::free(pMemory);
+}
+#else
+uint64_t AllocationCounter::get() noexcept {
+    return 0;
+}
+#endif
@@ -0,0 +1,131 @@
+#include <glbinding/gl46core/gl.h>
+#include <glbinding/glbinding.h>
+#include <glbinding/AbstractFunction.h>
+#include <glbinding/FunctionCall.h>
+//
+#include <chrono>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+//
+#include "gl_debug.hpp"
+using namespace gl;
+
+void GlDebug::enable_output() {
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); // report on the offending call, so a breakpoint in the callback shows the call stack
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    glDebugMessageCallback([](GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
+        static unsigned int messageCount = 0;
+        static constexpr unsigned int maxMessages = 10;
+
+        // only allow a certain number of messages to be printed
+        if (++messageCount >= maxMessages) {
+            if (messageCount == maxMessages) std::cerr << "Too many OpenGL debug messages" << std::endl;
+            return;
+        }
+
+        std::string severityName;
+        switch (severity) {
+            case GL_DEBUG_SEVERITY_HIGH:   severityName = "high"; break;
+            case GL_DEBUG_SEVERITY_MEDIUM: severityName = "medium"; break;
+            case GL_DEBUG_SEVERITY_LOW:    severityName = "low"; break;
+            default:                       severityName = "notification"; break;
+        }
+        std::string typeName;
+        switch (type) {
+            case GL_DEBUG_TYPE_ERROR:               typeName = "ERROR"; break;
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: typeName = "DEPRECATED_BEHAVIOR"; break;
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  typeName = "UNDEFINED_BEHAVIOR"; break;
+            case GL_DEBUG_TYPE_PORTABILITY:         typeName = "PORTABILITY"; break;
+            case GL_DEBUG_TYPE_PERFORMANCE:         typeName = "PERFORMANCE"; break;
+            default:                                typeName = "OTHER"; break;
+        }
+        std::cerr << "OpenGL " << typeName << " (" << severityName << ", id " << id << "): " << message << std::endl;
+    }, nullptr);
+}
+
+#ifdef ENABLE_GL_TRACER
+namespace {
+    typedef std::chrono::steady_clock clock;
+    struct Entry {
+        uint64_t calls = 0;
+        clock::duration time = clock::duration::zero();
+    };
+
+    // GL calls only happen on the render thread, no synchronization needed
+    std::unordered_map<const glbinding::AbstractFunction*, Entry> entries;
+    clock::time_point callStart;
+    std::string outputPath;
+    uint32_t framesLeft = 0;
+    uint32_t frameIndex = 0;
+    uint32_t sampleInterval = 1;
+    uint32_t sampledFrames = 0;
+
+    void set_sampling(bool bSample) {
+        if (bSample) {
+            glbinding::setCallbackMask(glbinding::CallbackMask::Before | glbinding::CallbackMask::After);
+            sampledFrames++;
+        }
+        else {
+            glbinding::setCallbackMask(glbinding::CallbackMask::None);
+        }
+    }
+
+    void write_report() {
+        std::vector<std::pair<const glbinding::AbstractFunction*, Entry>> sorted(entries.begin(), entries.end());
+        std::sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) { return a.second.time > b.second.time; });
+
+        std::ofstream file(outputPath);
+        file << "function,calls per frame,cpu us per frame,cpu ns per call\n";
+        for (auto& [function, entry] : sorted) {
+            double nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(entry.time).count();
+            file << function->name() << ',' << (double)entry.calls / sampledFrames << ',' << nanoseconds * 0.001 / sampledFrames << ',' << nanoseconds / entry.calls << '\n';
+        }
+        if (file) std::cout << "GL trace of " << sampledFrames << " frames written to " << outputPath << std::endl;
+        else std::cerr << "Failed to write GL trace " << outputPath << std::endl;
+    }
+}
+
+void GlTracer::start(const std::string& path, uint32_t nFrames, uint32_t interval) {
+    if (active()) return;
+    entries.clear();
+    outputPath = path;
+    framesLeft = nFrames;
+    frameIndex = 0;
+    sampleInterval = std::max(interval, 1u);
+    sampledFrames = 0;
+
+    glbinding::setBeforeCallback([](const glbinding::FunctionCall&) {
+        callStart = clock::now();
+    });
+    glbinding::setAfterCallback([](const glbinding::FunctionCall& call) {
+        Entry& entry = entries[call.function];
+        entry.calls++;
+        entry.time += clock::now() - callStart;
+    });
+    set_sampling(true);
+    std::cout << "GL trace started" << std::endl;
+}
+
+void GlTracer::end_frame() {
+    if (framesLeft == 0) return;
+    frameIndex++;
+    if (--framesLeft == 0) {
+        set_sampling(false);
+        write_report();
+        return;
+    }
+    set_sampling(frameIndex % sampleInterval == 0);
+}
+
+bool GlTracer::active() {
+    return framesLeft > 0;
+}
+#else
+void GlTracer::start(const std::string&, uint32_t, uint32_t) {}
+void GlTracer::end_frame() {}
+bool GlTracer::active() { return false; }
+#endif
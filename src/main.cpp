@@ -8,9 +8,9 @@ extern "C" {
 }
 #endif
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Start" << std::endl;
-    App app;
+    App app(AppOptions::parse(argc, argv));
     std::cout << "App built" << std::endl;
     return app.run();
 }
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include <glbinding/gl46core/gl.h>
 #include <glbinding/glbinding.h>
-#include <glbinding/AbstractFunction.h>
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include <imgui.h>
@@ -11,8 +10,9 @@
 #include <cassert>
 //
 #include "window.hpp"
+#include "gl_debug.hpp"
 
-Window::Window(int window_width, int window_height, int nSamples = 1) : width(window_width), height(window_height) {
+Window::Window(int window_width, int window_height, int nSamples, bool bHidden) : width(window_width), height(window_height) {
     if (SDL_InitSubSystem(SDL_InitFlags::SDL_INIT_VIDEO | SDL_InitFlags::SDL_INIT_AUDIO)) std::cout << SDL_GetError();
 
     // set opengl version
@@ -33,7 +33,7 @@ Window::Window(int window_width, int window_height, int nSamples = 1) : width(wi
 
     // create OpenGL window
     // SDL_GL_MULTISAMPLEBUFFERS
-    pWindow = SDL_CreateWindow("OpenGL Renderer", width, height, SDL_WINDOW_OPENGL);
+    pWindow = SDL_CreateWindow("OpenGL Renderer", width, height, bHidden ? SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN : SDL_WINDOW_OPENGL);
     if (pWindow == nullptr) std::cout << SDL_GetError();
 
     // create opengl context
@@ -42,45 +42,10 @@ Window::Window(int window_width, int window_height, int nSamples = 1) : width(wi
 
     // set up glbinding loader (lazy loading)
     glbinding::initialize(SDL_GL_GetProcAddress, false);
-    // error logging (currently enabled in release mode as well)
-    glbinding::setCallbackMaskExcept(glbinding::CallbackMask::After | glbinding::CallbackMask::ParametersAndReturnValue, { "glGetError" });
-    glbinding::setAfterCallback([](const glbinding::FunctionCall& call) {
-        static unsigned int callCount = 0;
-        static constexpr unsigned int maxCalls = 3;
-
-        const auto errorCode = glGetError();
-        if (errorCode != GL_NO_ERROR)
-        {
-            // only allow a certain number of errors to be printed
-            if (++callCount >= maxCalls) {
-                if (callCount == maxCalls) std::cerr << "Too many OpenGL errors" << std::endl;
-                return;
-            }
-
-            // print out the function name, parameters and return value
-            std::cout << call.function->name() << '(';
-            for (unsigned i = 0; i < call.parameters.size(); ++i) {
-                std::cout << call.parameters[i].get();
-                if (i < call.parameters.size() - 1) std::cout << ", ";
-            }
-            std::cout << ')';
-            if (call.returnValue) std::cout << " -> " << call.returnValue.get();
-            std::cout << '\n';
-
-            // print out error code
-            std::string error;
-            switch (errorCode) {
-                case GL_INVALID_ENUM:                  error = "INVALID_ENUM"; break;
-                case GL_INVALID_VALUE:                 error = "INVALID_VALUE"; break;
-                case GL_INVALID_OPERATION:             error = "INVALID_OPERATION"; break;
-                case GL_STACK_OVERFLOW:                error = "STACK_OVERFLOW"; break;
-                case GL_STACK_UNDERFLOW:               error = "STACK_UNDERFLOW"; break;
-                case GL_OUT_OF_MEMORY:                 error = "OUT_OF_MEMORY"; break;
-                case GL_INVALID_FRAMEBUFFER_OPERATION: error = "INVALID_FRAMEBUFFER_OPERATION"; break;
-            }
-            std::cout << "\tError: " << error << std::endl;
-        }
-    });
+    #ifndef NDEBUG
+    // error logging through KHR_debug output (debug context only), no glGetError after every call
+    GlDebug::enable_output();
+    #endif
 
     glClearColor(.5f, .5f, .5f, 1.0f); // default screen color
     glEnable(GL_CULL_FACE); // cull backfaces
@@ -115,4 +80,9 @@ Window::~Window() {
 
 void Window::swap() {
     SDL_GL_SwapWindow(pWindow);
+}
+
+// 1 = vsync, 0 = immediate (tearing), -1 = adaptive vsync (falls back to immediate if the driver lacks it)
+void Window::set_swap_interval(int interval) {
+    if (SDL_GL_SetSwapInterval(interval) != 0 && interval < 0) SDL_GL_SetSwapInterval(0);
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Obstacles of the arena have to end up in the flow field grid and steer the zombies around them
+// usage: flow-field-test, returns non-zero on failure
+#include "enemy_system/flow_field.hpp"
+
+#include <iostream>
+
+static int failures = 0;
+static void check(bool bCondition, const char* message)
+{
+    if (!bCondition)
+    {
+        std::cerr << "FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    // the default arena: walls at +-40 (one meter thick on both sides), the grid covers them like in App
+    float arenaSize = 40.0f;
+    FlowField flowField(glm::vec3(-arenaSize - 1.0f, 0.0f, -arenaSize - 1.0f), glm::vec3(arenaSize + 1.0f, 0.0f, arenaSize + 1.0f), 1.0f);
+    for (int i = -1; i <= 1; i += 2)
+    {
+        glm::vec3 xWall = glm::vec3(arenaSize * i, 0.0f, 0.0f);
+        glm::vec3 zWall = glm::vec3(0.0f, 0.0f, arenaSize * i);
+        flowField.add_obstacle(xWall - glm::vec3(1.0f, 5.0f, arenaSize), xWall + glm::vec3(1.0f, 5.0f, arenaSize));
+        flowField.add_obstacle(zWall - glm::vec3(arenaSize, 5.0f, 1.0f), zWall + glm::vec3(arenaSize, 5.0f, 1.0f));
+    }
+    check(flowField.count_blocked() > 0, "walls block cells");
+
+    // a wall between zombie and player: no line of sight, and the flow leads around it instead of into it
+    flowField.add_obstacle(glm::vec3(-10.0f, 0.0f, -0.5f), glm::vec3(10.0f, 2.0f, 0.5f));
+    glm::vec3 target = glm::vec3(0.5f, 0.0f, 10.5f);
+    glm::vec3 zombie = glm::vec3(0.5f, 0.0f, -10.5f);
+    flowField.update(target);
+    check(!flowField.line_of_sight(zombie, target), "wall blocks the line of sight");
+    check(flowField.line_of_sight(zombie, glm::vec3(5.5f, 0.0f, -5.5f)), "free line of sight on the same side");
+
+    glm::vec3 position = zombie;
+    bool bReached = false;
+    for (int step = 0; step < 200 && !bReached; step++)
+    {
+        glm::vec3 direction = flowField.direction(position);
+        if (direction == glm::vec3(0.0f))
+        {
+            bReached = glm::distance(position, target) < 1.0f;
+            break;
+        }
+        position += direction * 0.5f;
+        check(std::abs(position.z) > 0.5f || std::abs(position.x) > 10.0f, "path stays out of the wall");
+    }
+    check(bReached, "path around the wall reaches the target");
+
+    if (failures == 0)
+        std::cout << "flow field: all checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
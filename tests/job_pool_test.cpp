@@ -0,0 +1,47 @@
+// Back-to-back parallel loops of different sizes must run every chunk exactly once and only return when all are done
+// usage: job-pool-test, returns non-zero on failure
+#include "job_pool.hpp"
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+
+static int failures = 0;
+static void check(bool bCondition, const char* message)
+{
+    if (!bCondition)
+    {
+        std::cerr << "FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    JobPool jobs(4);
+    bool bExactlyOnce = true;
+    for (size_t iLoop = 0; iLoop < 20000; iLoop++)
+    {
+        // alternating small and large loops: a late worker of a small loop would land in the chunks of the next one
+        size_t count = iLoop % 2 == 0 ? 3 * 16 : 40 * 16;
+        std::vector<std::atomic<uint32_t>> calls(count);
+        auto function = [&calls](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                calls[i].fetch_add(1, std::memory_order_relaxed);
+        };
+        jobs.parallel_for(count, 16, function);
+        // the vector dies here, a worker still writing into it would be caught by the next loop's counts
+        for (auto& call : calls)
+            bExactlyOnce = bExactlyOnce && call.load() == 1;
+    }
+    check(bExactlyOnce, "every index is visited exactly once per loop");
+
+    size_t sum = 0;
+    auto single = [&sum](size_t begin, size_t end) { sum += end - begin; };
+    jobs.parallel_for(10, 16, single);
+    check(sum == 10, "a single chunk runs on the calling thread");
+
+    if (failures == 0)
+        std::cout << "job pool: all checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
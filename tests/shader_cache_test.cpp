@@ -0,0 +1,55 @@
+// Program binaries of the shader cache have to load back unchanged (no window or GL context needed)
+// usage: shader-cache-test, returns non-zero on failure
+#include <glbinding/gl46core/gl.h>
+using namespace gl;
+#include "shader_cache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+static int failures = 0;
+static void check(bool bCondition, const char* message)
+{
+    if (!bCondition)
+    {
+        std::cerr << "FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    std::string path = (std::filesystem::temp_directory_path() / "shader_cache_test.bin").string();
+    GLenum format = static_cast<GLenum>(0x8741);
+
+    // a tiny and a larger binary survive the round trip
+    for (size_t size : {size_t(8), size_t(100000)})
+    {
+        std::vector<char> binary(size);
+        for (size_t i = 0; i < size; i++)
+            binary[i] = (char)(i * 31 + 7);
+        check(ShaderCache::write_binary_file(path, format, binary), "binary written");
+
+        GLenum loadedFormat = static_cast<GLenum>(0);
+        std::vector<char> loaded;
+        check(ShaderCache::read_binary_file(path, loadedFormat, loaded), "binary read back");
+        check(loadedFormat == format, "format read back");
+        check(loaded == binary, "binary content read back");
+    }
+
+    // a file without a binary behind the format and a missing file are rejected
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write((const char*)&format, sizeof(format));
+    }
+    GLenum loadedFormat;
+    std::vector<char> loaded;
+    check(!ShaderCache::read_binary_file(path, loadedFormat, loaded), "empty binary rejected");
+    std::filesystem::remove(path);
+    check(!ShaderCache::read_binary_file(path, loadedFormat, loaded), "missing file rejected");
+
+    if (failures == 0)
+        std::cout << "shader cache: all checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
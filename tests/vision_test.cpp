@@ -0,0 +1,112 @@
+// Occlusion of the view checks against a flow field with obstacles, the time slicing after a swap-remove and the chase around a wall
+// usage: vision-test, returns non-zero on failure
+#include "enemy_system/flow_field.hpp"
+#include "enemy_system/vision.hpp"
+
+#include <iostream>
+
+static int failures = 0;
+static void check(bool bCondition, const char* message)
+{
+    if (!bCondition)
+    {
+        std::cerr << "FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+static void place(Vision& vision, size_t i, int id, glm::vec3 position, glm::vec3 forward)
+{
+    vision.ids[i] = id;
+    vision.posX[i] = position.x;
+    vision.posZ[i] = position.z;
+    vision.forwardX[i] = forward.x;
+    vision.forwardZ[i] = forward.z;
+}
+
+int main()
+{
+    // a wall along x between z = -0.5 and 0.5, the player stands north of it
+    FlowField flowField(glm::vec3(-38.0f, 0.0f, -38.0f), glm::vec3(38.0f, 0.0f, 38.0f), 1.0f);
+    flowField.add_obstacle(glm::vec3(-10.0f, 0.0f, -0.5f), glm::vec3(10.0f, 2.0f, 0.5f));
+    auto isOccluded = [&flowField](glm::vec3 from, glm::vec3 to) { return !flowField.line_of_sight(from, to); };
+    glm::vec3 player = glm::vec3(0.5f, 0.0f, 5.5f);
+    glm::vec3 north = glm::vec3(0.0f, 0.0f, 1.0f);
+
+    glm::vec3 beside = glm::vec3(30.5f, 0.0f, -5.5f); // sees the player past the end of the wall
+    glm::vec3 towardsPlayer = glm::normalize(player - beside);
+
+    // slot i of the far agents is checked on the ticks with (i + tick) % farInterval == 0
+    Vision vision(90.0f, 40.0f);
+    vision.resize(3);
+    place(vision, 0, 10, glm::vec3(0.5f, 0.0f, -5.5f), north);   // behind the wall, near
+    place(vision, 1, 11, glm::vec3(0.5f, 0.0f, -25.5f), north);  // behind the wall, far
+    place(vision, 2, 12, beside, towardsPlayer);                 // far
+    vision.update(player, 0, isOccluded);
+    check(!vision.visible[0], "wall hides the player from a near zombie");
+    check(!vision.visible[1], "wall hides the player from a far zombie");
+    check(vision.visible[2], "zombie beside the wall sees the player");
+    vision.update(player, 3);
+    check(vision.visible[0] && vision.visible[1], "without occlusion the view cone decides");
+
+    // far agents keep their result between their ticks
+    vision.update(player, 3, isOccluded);
+    place(vision, 1, 11, beside, towardsPlayer);
+    vision.update(player, 0, isOccluded);
+    check(!vision.visible[1], "far zombie is only checked every n-th tick");
+    vision.update(player, 3, isOccluded);
+    check(vision.visible[1], "far zombie is checked on its tick");
+
+    // zombie 12 of the last slot replaces the dead zombie 11 (swap-remove), it must not keep the result of 11
+    place(vision, 1, 11, glm::vec3(0.5f, 0.0f, -25.5f), north);
+    vision.update(player, 3, isOccluded);
+    check(!vision.visible[1], "zombie 11 behind the wall");
+    place(vision, 1, 12, beside, towardsPlayer);
+    vision.resize(2);
+    vision.update(player, 0, isOccluded);
+    check(vision.visible[1], "new zombie in a slot checks right away");
+
+    // shrinking and growing again starts the new slot fresh
+    vision.resize(1);
+    vision.update(player, 0, isOccluded);
+    vision.resize(2);
+    place(vision, 1, 13, beside, towardsPlayer);
+    vision.update(player, 0, isOccluded);
+    check(vision.visible[1], "grown slot checks right away");
+
+    // the chase of App::updateGame: a zombie that once saw the player follows the flow field around the wall,
+    // also while the wall hides the player and while it faces away from the player on the detour
+    glm::vec3 zombie = glm::vec3(0.5f, 0.0f, -5.5f);
+    glm::vec3 forward = glm::normalize(beside - zombie);
+    glm::vec3 target = beside; // first seen past the end of the wall
+    Vision chaser(90.0f, 40.0f);
+    chaser.resize(1);
+    bool bChasing = false;
+    bool bLostSight = false;
+    bool bReached = false;
+    for (uint32_t tick = 0; tick < 60 * 60 && !bReached; tick++)
+    {
+        if (tick == 1)
+            target = player; // behind the wall now
+        flowField.update(target);
+        place(chaser, 0, 20, zombie, forward);
+        chaser.update(target, tick, isOccluded);
+        bChasing = bChasing || chaser.visible[0];
+        bLostSight = bLostSight || (bChasing && !chaser.visible[0]);
+        if (bChasing)
+        {
+            glm::vec3 direction = flowField.chase_direction(zombie, target);
+            if (direction != glm::vec3(0.0f))
+                forward = direction;
+            zombie += direction * (2.5f / 60.0f);
+            check(std::abs(zombie.x) > 10.0f || std::abs(zombie.z) > 0.5f, "chasing zombie stays out of the wall");
+        }
+        bReached = glm::distance(zombie, target) < 1.0f;
+    }
+    check(bLostSight, "wall hides the player during the chase");
+    check(bReached, "zombie behind the wall reaches the player");
+
+    if (failures == 0)
+        std::cout << "vision: all checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}